@@ -0,0 +1,63 @@
+/*
+  Gerador pseudoaleatorio rapido e reprodutivel (xoshiro256**), semeado com splitmix64.
+  Cada simulacao guarda o seu estado, entao a mesma semente sempre da os mesmos resultados.
+ */
+
+#ifndef ALEATORIO_H
+#define ALEATORIO_H
+
+#include <stdint.h>
+#include <math.h>
+
+typedef struct
+{
+    uint64_t s[4];
+} aleatorio_t;
+
+static inline uint64_t splitmix64(uint64_t *estado)
+{
+    uint64_t z = (*estado += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static inline void aleatorio_semeia(aleatorio_t *gerador, uint64_t semente)
+{
+    for (int i = 0; i < 4; i++)
+        gerador->s[i] = splitmix64(&semente);
+}
+
+static inline uint64_t rotaciona(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t aleatorio_proximo(aleatorio_t *gerador)
+{
+    uint64_t *s = gerador->s;
+    uint64_t resultado = rotaciona(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotaciona(s[3], 45);
+
+    return resultado;
+}
+
+//uniforme em (0, 1], nunca zero para poder passar por log()
+static inline double aleatorio_uniforme(aleatorio_t *gerador)
+{
+    return ((aleatorio_proximo(gerador) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+static inline double aleatorio_exponencial(aleatorio_t *gerador, double media)
+{
+    return -media * log(aleatorio_uniforme(gerador));
+}
+
+#endif
@@ -0,0 +1,53 @@
+#include "analitico.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+int mmck_calcula(double intervalo, double corte, int barbeiros, int cadeiras, mmck_t *resultado)
+{
+    if (intervalo <= 0 || corte <= 0 || barbeiros < 1 || cadeiras < 0)
+        return -1;
+
+    int capacidade = barbeiros + cadeiras;
+    double carga = corte / intervalo; //lambda / mu
+    double *log_p = malloc((capacidade + 1) * sizeof(double));
+    if (log_p == NULL)
+        return -1;
+
+    //p(n) proporcional a carga^n / n! ate c e a carga^n / (c! c^(n-c)) depois;
+    //em log para nao estourar com cargas altas ou muitas cadeiras
+    log_p[0] = 0;
+    double maior = 0;
+    for (int n = 1; n <= capacidade; n++)
+    {
+        log_p[n] = log_p[n - 1] + log(carga) - log(n < barbeiros ? n : barbeiros);
+        if (log_p[n] > maior)
+            maior = log_p[n];
+    }
+
+    double soma = 0;
+    for (int n = 0; n <= capacidade; n++)
+        soma += exp(log_p[n] - maior);
+
+    double ocupados = 0, esperando = 0, pode_esperar = 0;
+    for (int n = 0; n <= capacidade; n++)
+    {
+        double p = exp(log_p[n] - maior) / soma;
+        ocupados += p * (n < barbeiros ? n : barbeiros);
+        if (n > barbeiros)
+            esperando += p * (n - barbeiros);
+        if (n >= barbeiros && n < capacidade)
+            pode_esperar += p; //chegadas que entram com todos os barbeiros ocupados
+    }
+    double cheia = exp(log_p[capacidade] - maior) / soma;
+    free(log_p);
+
+    double taxa_efetiva = (1 - cheia) / intervalo;
+    resultado->desistencia = cheia;
+    resultado->clientes_esperando = esperando;
+    resultado->espera_media = esperando / taxa_efetiva;
+    resultado->permanencia_media = resultado->espera_media + corte;
+    resultado->prob_esperar = pode_esperar / (1 - cheia);
+    resultado->ocupacao = ocupados / barbeiros;
+    return 0;
+}
@@ -0,0 +1,22 @@
+/*
+  Resultados exatos da fila M/M/c/K para validar a simulacao: chegadas de Poisson,
+  cortes exponenciais, c barbeiros e K = c + cadeiras clientes no maximo na barbearia.
+ */
+
+#ifndef ANALITICO_H
+#define ANALITICO_H
+
+typedef struct
+{
+    double desistencia; //P(K): o cliente encontra a barbearia cheia
+    double espera_media; //Wq dos clientes que entraram, em segundos
+    double permanencia_media; //W = Wq + 1/mu
+    double prob_esperar; //chance de um cliente que entrou precisar esperar
+    double ocupacao; //fracao media de barbeiros ocupados
+    double clientes_esperando; //Lq
+} mmck_t;
+
+//intervalo e corte sao as medias em segundos. retorna 0 ou -1 se os parametros nao fazem sentido
+int mmck_calcula(double intervalo, double corte, int barbeiros, int cadeiras, mmck_t *resultado);
+
+#endif
@@ -0,0 +1,125 @@
+#include "distribuicao.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+//tempo medio em cada estado do mmpp, em medias do intervalo: rajadas de dezenas de chegadas
+#define MMPP_DURACAO_ESTADO 50.0
+
+static const char *nomes[] = {"exp", "det", "mmpp", "pareto", "lognormal"};
+static const double parametros_padrao[] = {0, 0, 10.0, 1.5, 1.0};
+
+int distribuicao_le(distribuicao_t *distribuicao, const char *texto)
+{
+    const char *separador = strchr(texto, ':');
+    size_t tamanho = separador ? (size_t) (separador - texto) : strlen(texto);
+
+    for (int tipo = 0; tipo < (int) (sizeof(nomes) / sizeof(nomes[0])); tipo++)
+    {
+        if (strlen(nomes[tipo]) != tamanho || strncmp(texto, nomes[tipo], tamanho) != 0)
+            continue;
+
+        double parametro = parametros_padrao[tipo];
+        if (separador != NULL)
+        {
+            char *fim;
+            parametro = strtod(separador + 1, &fim);
+            if (*fim != '\0')
+                return -1;
+        }
+        if ((tipo == DISTRIBUICAO_MMPP && parametro < 1) || (tipo == DISTRIBUICAO_PARETO && parametro <= 1) ||
+            (tipo == DISTRIBUICAO_LOGNORMAL && parametro < 0))
+            return -1;
+
+        distribuicao->tipo = (tipo_distribuicao_t) tipo;
+        distribuicao->parametro = parametro;
+        distribuicao->rajada = 0;
+        distribuicao->restante_estado = 0;
+        return 0;
+    }
+    return -1;
+}
+
+
+const char *distribuicao_nome(const distribuicao_t *distribuicao, char *texto, int tamanho)
+{
+    if (parametros_padrao[distribuicao->tipo] == 0)
+        snprintf(texto, tamanho, "%s", nomes[distribuicao->tipo]);
+    else
+        snprintf(texto, tamanho, "%s:%g", nomes[distribuicao->tipo], distribuicao->parametro);
+    return texto;
+}
+
+
+static double normal(aleatorio_t *gerador)
+{
+    //Box-Muller, usando so um dos dois valores
+    double u = aleatorio_uniforme(gerador);
+    double v = aleatorio_uniforme(gerador);
+    return sqrt(-2 * log(u)) * cos(6.283185307179586 * v);
+}
+
+
+//intervalo ate a proxima chegada de um Poisson cuja taxa muda com o estado da cadeia
+static double amostra_mmpp(distribuicao_t *distribuicao, aleatorio_t *gerador)
+{
+    //metade do tempo em cada estado: taxa media = (calmo + rajada) / 2, rajada = k * calmo
+    double k = distribuicao->parametro;
+    double media_calmo = distribuicao->media * (1 + k) / 2;
+    double media_rajada = media_calmo / k;
+    double duracao_estado = MMPP_DURACAO_ESTADO * distribuicao->media;
+
+    double intervalo = 0;
+    while (1)
+    {
+        if (distribuicao->restante_estado <= 0)
+            distribuicao->restante_estado = aleatorio_exponencial(gerador, duracao_estado);
+
+        double proximo = aleatorio_exponencial(gerador, distribuicao->rajada ? media_rajada : media_calmo);
+        if (proximo < distribuicao->restante_estado)
+        {
+            distribuicao->restante_estado -= proximo;
+            return intervalo + proximo;
+        }
+
+        //o estado muda antes da chegada; como a exponencial nao tem memoria, sorteia de novo no outro
+        intervalo += distribuicao->restante_estado;
+        distribuicao->restante_estado = 0;
+        distribuicao->rajada = !distribuicao->rajada;
+    }
+}
+
+
+double distribuicao_amostra(distribuicao_t *distribuicao, aleatorio_t *gerador)
+{
+    double media = distribuicao->media;
+
+    switch (distribuicao->tipo)
+    {
+        case DISTRIBUICAO_EXPONENCIAL:
+            return aleatorio_exponencial(gerador, media);
+
+        case DISTRIBUICAO_DETERMINISTICA:
+            return media;
+
+        case DISTRIBUICAO_MMPP:
+            return amostra_mmpp(distribuicao, gerador);
+
+        case DISTRIBUICAO_PARETO:
+        {
+            //minimo escolhido para a media dar certo: media = minimo * a / (a - 1)
+            double a = distribuicao->parametro;
+            double minimo = media * (a - 1) / a;
+            return minimo / pow(aleatorio_uniforme(gerador), 1 / a);
+        }
+
+        case DISTRIBUICAO_LOGNORMAL:
+        {
+            double s = distribuicao->parametro;
+            return exp(log(media) - s * s / 2 + s * normal(gerador));
+        }
+    }
+    return media;
+}
@@ -0,0 +1,46 @@
+/*
+  Distribuicoes dos intervalos entre chegadas e dos tempos de corte.
+  Todas sao parametrizadas pela media, entao trocar a distribuicao muda a variabilidade
+  da carga mas nao o seu volume:
+    exp          exponencial (chegadas de Poisson)
+    det          deterministica, sempre a media
+    mmpp[:k]     Poisson modulado por uma cadeia de Markov de dois estados (rajada e calmo,
+                 com taxas na razao k, padrao 10), passando em media o mesmo tempo em cada
+    pareto[:a]   Pareto de forma a > 1 (padrao 1.5, variancia infinita)
+    lognormal[:s] lognormal com desvio s do logaritmo (padrao 1)
+ */
+
+#ifndef DISTRIBUICAO_H
+#define DISTRIBUICAO_H
+
+#include "aleatorio.h"
+
+typedef enum
+{
+    DISTRIBUICAO_EXPONENCIAL = 0,
+    DISTRIBUICAO_DETERMINISTICA = 1,
+    DISTRIBUICAO_MMPP = 2,
+    DISTRIBUICAO_PARETO = 3,
+    DISTRIBUICAO_LOGNORMAL = 4
+} tipo_distribuicao_t;
+
+typedef struct
+{
+    tipo_distribuicao_t tipo;
+    double media;
+    double parametro; //razao da rajada (mmpp), forma (pareto) ou desvio do log (lognormal)
+
+    //estado do mmpp: cada copia da distribuicao tem a sua cadeia
+    int rajada;
+    double restante_estado;
+} distribuicao_t;
+
+//le "nome[:parametro]"; a media fica como esta. retorna 0 ou -1 se o texto nao e valido
+int distribuicao_le(distribuicao_t *distribuicao, const char *texto);
+
+//escreve o nome e o parametro, como distribuicao_le os aceita
+const char *distribuicao_nome(const distribuicao_t *distribuicao, char *texto, int tamanho);
+
+double distribuicao_amostra(distribuicao_t *distribuicao, aleatorio_t *gerador);
+
+#endif
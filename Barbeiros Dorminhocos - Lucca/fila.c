@@ -0,0 +1,123 @@
+#include "fila.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+int fila_inicia(fila_t *fila, size_t capacidade)
+{
+    if (capacidade == 0)
+        return -1;
+
+    fila->celulas = malloc(capacidade * sizeof(celula_t));
+    if (fila->celulas == NULL)
+        return -1;
+
+    //a celula i comeca livre para a posicao i
+    for (size_t i = 0; i < capacidade; i++)
+        fila->celulas[i].sequencia = 2 * i;
+
+    fila->capacidade = capacidade;
+    fila->fundo = 0;
+    fila->frente = 0;
+    return 0;
+}
+
+
+void fila_libera(fila_t *fila)
+{
+    free(fila->celulas);
+    fila->celulas = NULL;
+}
+
+
+int fila_enfileira(fila_t *fila, cliente_t cliente)
+{
+    celula_t *celula;
+    size_t posicao = __atomic_load_n(&fila->fundo, __ATOMIC_RELAXED);
+
+    while (1)
+    {
+        celula = &fila->celulas[posicao % fila->capacidade];
+        size_t sequencia = __atomic_load_n(&celula->sequencia, __ATOMIC_ACQUIRE);
+        intptr_t diferenca = (intptr_t) sequencia - (intptr_t) (2 * posicao);
+
+        if (diferenca == 0)
+        {
+            //a celula esta livre para esta posicao, tenta reserva-la
+            if (__atomic_compare_exchange_n(&fila->fundo, &posicao, posicao + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (diferenca < 0)
+        {
+            //a celula ainda guarda o cliente de uma volta anterior: todas as cadeiras ocupadas
+            return 0;
+        }
+        else
+        {
+            //outro produtor ja reservou esta posicao
+            posicao = __atomic_load_n(&fila->fundo, __ATOMIC_RELAXED);
+        }
+    }
+
+    celula->cliente = cliente;
+    __atomic_store_n(&celula->sequencia, 2 * posicao + 1, __ATOMIC_RELEASE); //publica para os consumidores
+    return 1;
+}
+
+
+int fila_desenfileira(fila_t *fila, cliente_t *cliente)
+{
+    celula_t *celula;
+    size_t posicao = __atomic_load_n(&fila->frente, __ATOMIC_RELAXED);
+
+    while (1)
+    {
+        celula = &fila->celulas[posicao % fila->capacidade];
+        size_t sequencia = __atomic_load_n(&celula->sequencia, __ATOMIC_ACQUIRE);
+        intptr_t diferenca = (intptr_t) sequencia - (intptr_t) (2 * posicao + 1);
+
+        if (diferenca == 0)
+        {
+            if (__atomic_compare_exchange_n(&fila->frente, &posicao, posicao + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (diferenca < 0)
+        {
+            //vazia, ou o produtor desta posicao ainda nao terminou de escrever
+            return 0;
+        }
+        else
+        {
+            posicao = __atomic_load_n(&fila->frente, __ATOMIC_RELAXED);
+        }
+    }
+
+    *cliente = celula->cliente;
+    //libera a celula para o produtor da proxima volta
+    __atomic_store_n(&celula->sequencia, 2 * (posicao + fila->capacidade), __ATOMIC_RELEASE);
+    return 1;
+}
+
+
+int fila_espia(const fila_t *fila, cliente_t *cliente)
+{
+    size_t posicao = __atomic_load_n(&fila->frente, __ATOMIC_RELAXED);
+    const celula_t *celula = &fila->celulas[posicao % fila->capacidade];
+
+    if (__atomic_load_n(&celula->sequencia, __ATOMIC_ACQUIRE) != 2 * posicao + 1)
+        return 0;
+    *cliente = celula->cliente;
+    //como num seqlock: se a sequencia mudou durante a copia ela pode estar misturada
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&celula->sequencia, __ATOMIC_RELAXED) == 2 * posicao + 1;
+}
+
+
+size_t fila_tamanho(const fila_t *fila)
+{
+    size_t frente = __atomic_load_n(&fila->frente, __ATOMIC_RELAXED);
+    size_t fundo = __atomic_load_n(&fila->fundo, __ATOMIC_RELAXED);
+    return fundo > frente ? fundo - frente : 0;
+}
@@ -0,0 +1,65 @@
+/*
+  Fila de espera (cadeiras) da barbearia, sem locks.
+  E uma fila circular limitada para varios produtores e varios consumidores no estilo
+  de Dmitry Vyukov: cada celula tem um numero de sequencia que diz se ela esta livre
+  para a posicao que o produtor reservou ou pronta para a posicao do consumidor.
+  A sequencia vale 2*posicao quando livre e 2*posicao+1 quando ocupada; com o fator 2
+  os dois estados nunca se confundem, mesmo numa fila de uma cadeira so.
+  Enfileirar e desenfileirar nunca bloqueiam: falham na hora se a fila esta cheia ou vazia.
+ */
+
+#ifndef FILA_H
+#define FILA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TAMANHO_LINHA_CACHE 64
+
+//registro de um cliente; os instantes sao de CLOCK_MONOTONIC, em ns
+typedef struct
+{
+    long id;
+    int classe; //classe de prioridade, 0 e a mais urgente
+    uint64_t chegada;
+    uint64_t prazo; //instante limite para comecar o corte, 0 = sem prazo
+    uint64_t sentou;
+    uint64_t inicio; //inicio do corte
+    uint64_t saida;
+} cliente_t;
+
+typedef struct
+{
+    size_t sequencia;
+    cliente_t cliente;
+} celula_t;
+
+typedef struct
+{
+    celula_t *celulas;
+    size_t capacidade;
+    //frente e fundo ficam em linhas de cache proprias (o alinhamento arredonda o tamanho da struct),
+    //assim produtores e consumidores nao disputam a mesma linha
+    size_t fundo __attribute__((aligned(TAMANHO_LINHA_CACHE))); //proxima posicao a enfileirar
+    size_t frente __attribute__((aligned(TAMANHO_LINHA_CACHE))); //proxima posicao a desenfileirar
+} fila_t;
+
+//capacidade e o numero de cadeiras, nao precisa ser potencia de 2. retorna 0 ou -1
+int fila_inicia(fila_t *fila, size_t capacidade);
+
+void fila_libera(fila_t *fila);
+
+//retorna 1 se o cliente sentou, 0 se todas as cadeiras estao ocupadas
+int fila_enfileira(fila_t *fila, cliente_t cliente);
+
+//retorna 1 e preenche cliente, ou 0 se nao ha cliente pronto
+int fila_desenfileira(fila_t *fila, cliente_t *cliente);
+
+//copia o cliente da frente sem tira-lo; retorna 0 se nao ha cliente pronto. sob concorrencia
+//ele pode ser levado por outro consumidor logo depois: serve para escolher de qual fila tirar
+int fila_espia(const fila_t *fila, cliente_t *cliente);
+
+//numero aproximado de clientes sentados (pode estar desatualizado sob concorrencia)
+size_t fila_tamanho(const fila_t *fila);
+
+#endif
@@ -0,0 +1,489 @@
+/*
+  Benchmark da passagem cliente -> barbeiro com primitivas de sincronizacao trocaveis.
+  Os produtores (clientes) tentam sentar numa fila limitada e vao embora se ela estiver
+  cheia; os consumidores (barbeiros) dormem enquanto nao ha clientes. Cada primitiva
+  implementa a mesma passagem:
+    mutex     fila circular protegida por pthread_mutex, barbeiros dormem em pthread_cond
+    semaforo  fila sem lock (fila.c) e um sem_t contando os clientes, como em main.c
+    futex     fila sem lock e um contador proprio esperado com FUTEX_WAIT
+    giro      como futex, mas o barbeiro gira um pouco antes de dormir
+    semlock   fila sem lock e barbeiros que nunca dormem, so giram
+  Para cada primitiva e numero de threads mede a vazao, a latencia da passagem (do
+  momento em que o cliente chega ate o barbeiro recebe-lo) e as trocas de contexto.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <sched.h>
+#include <time.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <sys/resource.h>
+
+#include "fila.h"
+#include "metricas.h"
+
+#define MAX_THREADS 256
+
+//configuracao, alteravel pela linha de comando
+long total_passagens = 1000000;
+int max_threads = 4;
+int capacidade = 7;
+long intervalo_ns = 0; //espera ativa do cliente entre chegadas
+long corte_ns = 0; //espera ativa do barbeiro por cliente
+int giros_antes_de_dormir = 2000;
+const char *so_primitiva = NULL;
+
+int encerrando = 0;
+
+uint64_t agora_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+
+void espera_ativa(long ns)
+{
+    if (ns <= 0)
+        return;
+    uint64_t fim = agora_ns() + ns;
+    while (agora_ns() < fim)
+        ;
+}
+
+
+static inline void pausa()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+//==================== mutex + variavel de condicao ====================
+
+pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t cond_barbeiros = PTHREAD_COND_INITIALIZER;
+cliente_t *fila_clientes;
+int frente_fila, sentados;
+
+int mutex_inicia()
+{
+    fila_clientes = malloc(capacidade * sizeof(cliente_t));
+    frente_fila = sentados = 0;
+    return fila_clientes != NULL ? 0 : -1;
+}
+
+int mutex_entrega(cliente_t cliente)
+{
+    pthread_mutex_lock(&mutex);
+    if (sentados == capacidade)
+    {
+        pthread_mutex_unlock(&mutex);
+        return 0;
+    }
+    int fundo = frente_fila + sentados;
+    fila_clientes[fundo >= capacidade ? fundo - capacidade : fundo] = cliente;
+    sentados++;
+    pthread_cond_signal(&cond_barbeiros);
+    pthread_mutex_unlock(&mutex);
+    return 1;
+}
+
+int mutex_recebe(cliente_t *cliente)
+{
+    pthread_mutex_lock(&mutex);
+    while (sentados == 0 && !encerrando)
+        pthread_cond_wait(&cond_barbeiros, &mutex);
+    if (sentados == 0)
+    {
+        pthread_mutex_unlock(&mutex);
+        return 0;
+    }
+    *cliente = fila_clientes[frente_fila];
+    if (++frente_fila == capacidade)
+        frente_fila = 0;
+    sentados--;
+    pthread_mutex_unlock(&mutex);
+    return 1;
+}
+
+void mutex_encerra(int consumidores)
+{
+    (void) consumidores;
+    pthread_mutex_lock(&mutex);
+    encerrando = 1;
+    pthread_cond_broadcast(&cond_barbeiros);
+    pthread_mutex_unlock(&mutex);
+}
+
+void mutex_libera()
+{
+    free(fila_clientes);
+}
+
+//==================== fila sem lock, comum as outras primitivas ====================
+
+fila_t fila;
+
+int fila_sem_lock_inicia()
+{
+    return fila_inicia(&fila, capacidade);
+}
+
+void fila_sem_lock_libera()
+{
+    fila_libera(&fila);
+}
+
+//depois de pegar a ficha de um cliente o barbeiro pode encontrar a celula ainda sendo publicada
+int retira_com_ficha(cliente_t *cliente)
+{
+    while (!fila_desenfileira(&fila, cliente))
+    {
+        if (__atomic_load_n(&encerrando, __ATOMIC_ACQUIRE))
+            return 0;
+        sched_yield();
+    }
+    return 1;
+}
+
+//==================== semaforo POSIX ====================
+
+sem_t sem_clientes;
+
+int semaforo_inicia()
+{
+    sem_init(&sem_clientes, 0, 0);
+    return fila_sem_lock_inicia();
+}
+
+int semaforo_entrega(cliente_t cliente)
+{
+    if (!fila_enfileira(&fila, cliente))
+        return 0;
+    sem_post(&sem_clientes);
+    return 1;
+}
+
+int semaforo_recebe(cliente_t *cliente)
+{
+    sem_wait(&sem_clientes);
+    return retira_com_ficha(cliente);
+}
+
+void semaforo_encerra(int consumidores)
+{
+    __atomic_store_n(&encerrando, 1, __ATOMIC_RELEASE);
+    for (int i = 0; i < consumidores; i++)
+        sem_post(&sem_clientes);
+}
+
+void semaforo_libera()
+{
+    sem_destroy(&sem_clientes);
+    fila_sem_lock_libera();
+}
+
+//==================== futex ====================
+
+//semaforo contador feito direto sobre o futex: so entra no kernel quando ha quem acordar
+typedef struct
+{
+    int valor __attribute__((aligned(TAMANHO_LINHA_CACHE)));
+    int esperando;
+} semaforo_futex_t;
+
+semaforo_futex_t clientes_futex;
+
+static long futex(int *endereco, int operacao, int valor)
+{
+    return syscall(SYS_futex, endereco, operacao, valor, NULL, NULL, 0);
+}
+
+static int futex_tenta(semaforo_futex_t *semaforo)
+{
+    int valor = __atomic_load_n(&semaforo->valor, __ATOMIC_RELAXED);
+    while (valor > 0)
+    {
+        if (__atomic_compare_exchange_n(&semaforo->valor, &valor, valor - 1, 1, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            return 1;
+    }
+    return 0;
+}
+
+//giros > 0: confere o contador giros vezes antes de dormir (giro e depois estaciona)
+void futex_espera(semaforo_futex_t *semaforo, int giros)
+{
+    for (int i = 0; i < giros; i++)
+    {
+        if (futex_tenta(semaforo))
+            return;
+        pausa();
+    }
+
+    while (!futex_tenta(semaforo))
+    {
+        __atomic_fetch_add(&semaforo->esperando, 1, __ATOMIC_SEQ_CST);
+        //o kernel so bloqueia se o valor ainda for 0, entao uma postagem no meio nao se perde
+        futex(&semaforo->valor, FUTEX_WAIT_PRIVATE, 0);
+        __atomic_fetch_sub(&semaforo->esperando, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void futex_posta(semaforo_futex_t *semaforo, int quantidade)
+{
+    __atomic_fetch_add(&semaforo->valor, quantidade, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&semaforo->esperando, __ATOMIC_SEQ_CST) > 0)
+        futex(&semaforo->valor, FUTEX_WAKE_PRIVATE, quantidade);
+}
+
+int futex_inicia()
+{
+    clientes_futex.valor = 0;
+    clientes_futex.esperando = 0;
+    return fila_sem_lock_inicia();
+}
+
+int futex_entrega(cliente_t cliente)
+{
+    if (!fila_enfileira(&fila, cliente))
+        return 0;
+    futex_posta(&clientes_futex, 1);
+    return 1;
+}
+
+int futex_recebe(cliente_t *cliente)
+{
+    futex_espera(&clientes_futex, 0);
+    return retira_com_ficha(cliente);
+}
+
+int giro_recebe(cliente_t *cliente)
+{
+    futex_espera(&clientes_futex, giros_antes_de_dormir);
+    return retira_com_ficha(cliente);
+}
+
+void futex_encerra(int consumidores)
+{
+    __atomic_store_n(&encerrando, 1, __ATOMIC_RELEASE);
+    futex_posta(&clientes_futex, consumidores);
+}
+
+//==================== sem lock, sem dormir ====================
+
+int semlock_entrega(cliente_t cliente)
+{
+    return fila_enfileira(&fila, cliente);
+}
+
+int semlock_recebe(cliente_t *cliente)
+{
+    for (int falhas = 1; !fila_desenfileira(&fila, cliente); falhas++)
+    {
+        if (__atomic_load_n(&encerrando, __ATOMIC_ACQUIRE))
+            return fila_desenfileira(&fila, cliente);
+        if (falhas % 64 == 0)
+            sched_yield(); //com mais threads que CPUs, girar sem ceder nunca termina
+        else
+            pausa();
+    }
+    return 1;
+}
+
+void semlock_encerra(int consumidores)
+{
+    (void) consumidores;
+    __atomic_store_n(&encerrando, 1, __ATOMIC_RELEASE);
+}
+
+//==================== benchmark ====================
+
+typedef struct
+{
+    const char *nome;
+    int (*inicia)(void);
+    int (*entrega)(cliente_t cliente); //1 se o cliente sentou, 0 se foi embora
+    int (*recebe)(cliente_t *cliente); //bloqueia; 0 quando encerrando e sem clientes
+    void (*encerra)(int consumidores);
+    void (*libera)(void);
+} primitiva_t;
+
+const primitiva_t primitivas[] =
+{
+    {"mutex", mutex_inicia, mutex_entrega, mutex_recebe, mutex_encerra, mutex_libera},
+    {"semaforo", semaforo_inicia, semaforo_entrega, semaforo_recebe, semaforo_encerra, semaforo_libera},
+    {"futex", futex_inicia, futex_entrega, futex_recebe, futex_encerra, fila_sem_lock_libera},
+    {"giro", futex_inicia, futex_entrega, giro_recebe, futex_encerra, fila_sem_lock_libera},
+    {"semlock", fila_sem_lock_inicia, semlock_entrega, semlock_recebe, semlock_encerra, fila_sem_lock_libera},
+};
+#define NUM_PRIMITIVAS ((int) (sizeof(primitivas) / sizeof(primitivas[0])))
+
+typedef struct
+{
+    const primitiva_t *primitiva;
+    long clientes; //produtor: quantos gerar
+    long sentados;
+    long recebidos;
+    histograma_t latencia;
+} trabalho_t;
+
+void *produtor(void *arg)
+{
+    trabalho_t *trabalho = arg;
+    for (long i = 0; i < trabalho->clientes; i++)
+    {
+        cliente_t cliente = {.id = i};
+        cliente.chegada = agora_ns();
+        trabalho->sentados += trabalho->primitiva->entrega(cliente);
+        espera_ativa(intervalo_ns);
+    }
+    return NULL;
+}
+
+void *consumidor(void *arg)
+{
+    trabalho_t *trabalho = arg;
+    cliente_t cliente;
+    while (trabalho->primitiva->recebe(&cliente))
+    {
+        histograma_registra(&trabalho->latencia, agora_ns() - cliente.chegada);
+        trabalho->recebidos++;
+        espera_ativa(corte_ns);
+    }
+    return NULL;
+}
+
+long trocas_de_contexto()
+{
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    return uso.ru_nvcsw + uso.ru_nivcsw;
+}
+
+//threads produtores e threads consumidores passando total_passagens clientes
+int executa(const primitiva_t *primitiva, int threads)
+{
+    pthread_t produtores[MAX_THREADS], consumidores[MAX_THREADS];
+    trabalho_t *trabalhos = calloc(2 * threads, sizeof(trabalho_t));
+    if (trabalhos == NULL || primitiva->inicia() != 0)
+    {
+        perror(primitiva->nome);
+        free(trabalhos);
+        return -1;
+    }
+    encerrando = 0;
+
+    long trocas = trocas_de_contexto();
+    uint64_t inicio = agora_ns();
+    for (int i = 0; i < threads; i++)
+    {
+        trabalhos[threads + i].primitiva = primitiva;
+        pthread_create(&consumidores[i], NULL, consumidor, &trabalhos[threads + i]);
+    }
+    for (int i = 0; i < threads; i++)
+    {
+        trabalhos[i].primitiva = primitiva;
+        trabalhos[i].clientes = total_passagens / threads + (i < total_passagens % threads);
+        pthread_create(&produtores[i], NULL, produtor, &trabalhos[i]);
+    }
+
+    for (int i = 0; i < threads; i++)
+        pthread_join(produtores[i], NULL);
+    primitiva->encerra(threads);
+    for (int i = 0; i < threads; i++)
+        pthread_join(consumidores[i], NULL);
+    double segundos = (agora_ns() - inicio) / 1e9;
+    trocas = trocas_de_contexto() - trocas;
+
+    histograma_t *latencia = &trabalhos[threads].latencia;
+    long sentados = 0, recebidos = 0;
+    for (int i = 0; i < threads; i++)
+    {
+        sentados += trabalhos[i].sentados;
+        recebidos += trabalhos[threads + i].recebidos;
+        if (i > 0)
+            histograma_soma(latencia, &trabalhos[threads + i].latencia);
+    }
+    if (sentados != recebidos)
+        fprintf(stderr, "%s: %ld clientes sentaram mas %ld foram atendidos\n", primitiva->nome, sentados, recebidos);
+
+    printf("%-10s %8d %14.0f %10.2f%% %10.2f %10.2f %10.2f %10.2f %12ld\n", primitiva->nome, threads,
+           recebidos / segundos, 100.0 * (total_passagens - sentados) / total_passagens,
+           histograma_percentil(latencia, 0.50) / 1e3, histograma_percentil(latencia, 0.99) / 1e3,
+           histograma_percentil(latencia, 0.999) / 1e3, latencia->maximo / 1e3, trocas);
+
+    primitiva->libera();
+    free(trabalhos);
+    return 0;
+}
+
+void uso(const char *programa)
+{
+    fprintf(stderr,
+            "Uso: %s [-n passagens] [-t threads] [-C cadeiras] [-i intervalo_ns] [-c corte_ns] [-g giros] [-p primitiva]\n"
+            "  -n  clientes por execução (padrão 1000000)\n"
+            "  -t  máximo de produtores e de consumidores; testa 1, 2, 4, ... (padrão 4)\n"
+            "  -C  cadeiras da fila (padrão 7)\n"
+            "  -i  espera ativa do cliente entre chegadas, em ns (padrão 0)\n"
+            "  -c  espera ativa do barbeiro por cliente, em ns (padrão 0)\n"
+            "  -g  giros antes de dormir na primitiva giro (padrão 2000)\n"
+            "  -p  só uma primitiva: mutex, semaforo, futex, giro ou semlock\n",
+            programa);
+}
+
+int main(int argc, char *argv[])
+{
+    int opcao;
+    while ((opcao = getopt(argc, argv, "n:t:C:i:c:g:p:")) != -1)
+    {
+        switch (opcao)
+        {
+            case 'n': total_passagens = atol(optarg); break;
+            case 't': max_threads = atoi(optarg); break;
+            case 'C': capacidade = atoi(optarg); break;
+            case 'i': intervalo_ns = atol(optarg); break;
+            case 'c': corte_ns = atol(optarg); break;
+            case 'g': giros_antes_de_dormir = atoi(optarg); break;
+            case 'p': so_primitiva = optarg; break;
+            default: uso(argv[0]); return 1;
+        }
+    }
+    if (total_passagens < 1 || max_threads < 1 || max_threads > MAX_THREADS || capacidade < 1 ||
+        intervalo_ns < 0 || corte_ns < 0 || giros_antes_de_dormir < 0)
+    {
+        uso(argv[0]);
+        return 1;
+    }
+
+    printf("%ld passagens por execução, %d cadeiras, intervalo %ld ns, corte %ld ns, %ld CPU(s)\n",
+           total_passagens, capacidade, intervalo_ns, corte_ns, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-10s %8s %14s %11s %10s %10s %10s %10s %12s\n", "primitiva", "threads", "passagens/s", "desistencia",
+           "p50(us)", "p99(us)", "p99.9(us)", "max(us)", "trocas ctx");
+
+    int encontrada = 0;
+    for (int i = 0; i < NUM_PRIMITIVAS; i++)
+    {
+        if (so_primitiva != NULL && strcmp(so_primitiva, primitivas[i].nome) != 0)
+            continue;
+        encontrada = 1;
+        for (int threads = 1; threads <= max_threads; threads *= 2)
+        {
+            if (executa(&primitivas[i], threads) != 0)
+                return 1;
+        }
+    }
+    if (!encontrada)
+    {
+        uso(argv[0]);
+        return 1;
+    }
+    return 0;
+}
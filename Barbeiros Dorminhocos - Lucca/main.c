@@ -1,124 +1,1001 @@
+#define _GNU_SOURCE
 #include <stdio.h>
+#include <stdlib.h>
 #include <pthread.h>
 #include <semaphore.h>
 #include <unistd.h>
+#include <sched.h>
+#include <time.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/resource.h>
+
+#include "fila.h"
+#include "sala.h"
+#include "simulacao.h"
+#include "metricas.h"
+#include "distribuicao.h"
+#include "analitico.h"
 
 #define NUM_CADEIRAS 7
 #define NUM_BARBEIROS 2
+#define MAX_BARBEIROS 256
+#define MAX_GERADORES 64
 
-pthread_mutex_t mutex;
-sem_t sem_cadeiras;
-sem_t sem_barbeiros[NUM_BARBEIROS];
+sem_t sem_clientes; //quantos clientes sentados ainda nao foram chamados; os barbeiros dormem nele
+sem_t sem_barbeiros[MAX_BARBEIROS]; //com entrega direta cada barbeiro dorme no seu
+
+//entrega direta: o cliente que chega passa direto para um barbeiro dormindo, sem sentar
+typedef struct
+{
+    int tem_cliente __attribute__((aligned(TAMANHO_LINHA_CACHE)));
+    cliente_t cliente;
+} caixa_t;
+
+caixa_t caixas[MAX_BARBEIROS]; //escrita por quem tira o barbeiro da pilha, lida por ele depois do sem_post
+pthread_mutex_t trava_ociosos = PTHREAD_MUTEX_INITIALIZER;
+int ociosos[MAX_BARBEIROS]; //pilha de barbeiros dormindo; o do topo dormiu por ultimo e esta com a cache mais quente
+int num_ociosos = 0; //lido sem a trava pelos clientes, para nao travar quando todos estao ocupados
+
+//aqui seria as "cadeiras da fila de espera", sem lock, com uma fila por classe de cliente.
+//com filas por barbeiro ha uma sala para cada barbeiro, senao uma so compartilhada
+sala_t *salas;
+int num_salas;
+long proximo_cliente_id = 0; //id do proximo cliente, incrementado atomicamente pelos geradores
+
+//configuracao, alteravel pela linha de comando
+int num_barbeiros = NUM_BARBEIROS;
+int num_cadeiras = NUM_CADEIRAS;
+int num_geradores = 1; //threads fixas que produzem as chegadas
+long intervalo_chegada_us = 500000; //intervalo medio entre chegadas na barbearia (somando todos os geradores)
+long tempo_corte_us = 3000000; //tempo medio do barbeiro cortando o cabelo
+distribuicao_t distribuicao_chegadas = {DISTRIBUICAO_DETERMINISTICA, 0, 0, 0, 0};
+distribuicao_t distribuicao_cortes = {DISTRIBUICAO_DETERMINISTICA, 0, 0, 0, 0};
+int validar = 0; //compara com a fila M/M/c/K
+int num_lojas = 1; //barbearias independentes atras de um roteador (so no tempo virtual)
+roteamento_t roteamento = ROTEAMENTO_ALEATORIO;
+int comparar_roteamentos = 0;
+long atualizacao_roteamento_us = 0; //0 = o roteador sempre ve os tamanhos exatos
+classe_t classes[MAX_CLASSES] = {{1, 1, 0}}; //sem -K todos os clientes sao de uma classe sem prazo
+int num_classes = 1;
+escalonamento_t escalonamento = ESCALONAMENTO_FIFO;
+int comparar_escalonamentos = 0;
+int entrega_direta = 0;
+int comparar_entregas = 0;
+long total_clientes = 0; //0 = gera clientes para sempre
+int silencioso = 0; //nao imprime uma linha por evento
+int filas_por_barbeiro = 0; //cada barbeiro tem sua fila e rouba das outras quando a dele esvazia
+int fixar_cpus = 0; //prende cada thread a uma CPU
+int corte_ocupado = 0; //o corte ocupa a CPU (espera ativa) em vez de dormir
+int tempo_virtual = 0; //simulacao de eventos discretos em vez de threads
+unsigned long semente = 1;
+int num_cpus = 1;
+
+int encerrando = 0; //os geradores terminaram, os barbeiros saem quando a fila esvaziar
+
+//contadores de cada thread, somados no fim para nao disputarem uma linha de cache
+typedef struct
+{
+    int id __attribute__((aligned(TAMANHO_LINHA_CACHE)));
+    int proxima_sala; //gerador: onde o despacho comeca a procurar uma cadeira
+    long roubos; //barbeiro: clientes tirados da fila de outro barbeiro
+    long entregas; //gerador: clientes passados direto a um barbeiro
+    metricas_t metricas;
+    distribuicao_t distribuicao; //intervalos do gerador ou cortes do barbeiro, em us
+    aleatorio_t aleatorio;
+} contadores_t;
+
+typedef struct
+{
+    metricas_t metricas; //soma das metricas de todas as threads
+    long roubos;
+    long entregas;
+    long trocas_voluntarias; //trocas de contexto do processo durante a execucao (getrusage)
+    long trocas_involuntarias;
+    double segundos_chegadas;
+    double segundos_total;
+} resultado_t;
+
+#define LOG(...) do { if (!silencioso) printf(__VA_ARGS__); } while (0)
+
+double agora()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
 
-int fila_clientes[NUM_CADEIRAS]; //aqui seria as "cadeiras da fila de espera"
-int frente_fila = 0; //indice da frente da fila
-int fundo_fila = 0; //indice do final da fila
-int proximo_cliente_id = 0; //id do proximo cliente
 
-pthread_cond_t cond_barbeiros = PTHREAD_COND_INITIALIZER;
+uint64_t agora_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
 
-void enfileirar_cliente(int cliente_id)
+void fixa_cpu(pthread_t thread, int cpu)
 {
-    fila_clientes[fundo_fila] = cliente_id;
-    fundo_fila = (fundo_fila + 1) % NUM_CADEIRAS; //circular
+    cpu_set_t conjunto;
+    CPU_ZERO(&conjunto);
+    CPU_SET(cpu % num_cpus, &conjunto);
+    pthread_setaffinity_np(thread, sizeof(conjunto), &conjunto);
 }
 
 
-int desenfileirar_cliente()
+//tira um barbeiro da pilha de ociosos; retorna o id ou -1 se nenhum esta dormindo
+int retira_ocioso()
 {
-    int cliente_id = fila_clientes[frente_fila];
-    frente_fila = (frente_fila + 1) % NUM_CADEIRAS; //circular
-    return cliente_id;
+    int barbeiro = -1;
+
+    if (__atomic_load_n(&num_ociosos, __ATOMIC_SEQ_CST) == 0)
+        return -1;
+    pthread_mutex_lock(&trava_ociosos);
+    if (num_ociosos > 0)
+    {
+        barbeiro = ociosos[num_ociosos - 1];
+        __atomic_store_n(&num_ociosos, num_ociosos - 1, __ATOMIC_SEQ_CST);
+    }
+    pthread_mutex_unlock(&trava_ociosos);
+    return barbeiro;
 }
 
 
-int tamanho_fila()
+//acorda um barbeiro ocioso, sem cliente na caixa, para olhar as filas. retorna 0 se nenhum dormia
+int avisa_ocioso()
 {
-    return (fundo_fila - frente_fila + NUM_CADEIRAS) % NUM_CADEIRAS;
+    int barbeiro = retira_ocioso();
+    if (barbeiro < 0)
+        return 0;
+    sem_post(&sem_barbeiros[barbeiro]);
+    return 1;
 }
 
 
-void *cliente(void *id)
+//chegada de um cliente na barbearia: o despacho procura uma cadeira livre, comecando
+//pela proxima sala da vez deste gerador, e so desiste se todas estiverem ocupadas
+void despacha_cliente(cliente_t cliente, contadores_t *contadores)
 {
-    int cliente_id = *(int *)id;
+    int sala = contadores->proxima_sala;
+    if (++contadores->proxima_sala == num_salas)
+        contadores->proxima_sala = 0;
 
-    pthread_mutex_lock(&mutex);
-    if (tamanho_fila() == NUM_CADEIRAS - 1)
+    //as fichas do semaforo sao os clientes sentados que nenhum barbeiro chamou ainda
+    int esperando;
+    sem_getvalue(&sem_clientes, &esperando);
+    if (esperando < 0)
+        esperando = 0;
+    contadores->metricas.fila_vista[esperando < num_cadeiras ? esperando : num_cadeiras]++;
+
+    cliente.sentou = agora_ns();
+
+    int barbeiro = entrega_direta ? retira_ocioso() : -1;
+    if (barbeiro >= 0)
     {
-        //se as cadeiras da fila de espera estiverem ocupadas o cliente vai embora
-        printf("O cliente %d não conseguiu se sentar e foi embora.\n", cliente_id);
+        //o barbeiro que dormiu por ultimo recebe o cliente na caixa e so ele acorda
+        cliente.prazo = classe_prazo(&classes[cliente.classe], cliente.chegada);
+        caixas[barbeiro].cliente = cliente;
+        caixas[barbeiro].tem_cliente = 1;
+        contadores->entregas++;
+        LOG("Cliente %ld entrou na barbearia e foi direto para o barbeiro %d.\n", cliente.id, barbeiro);
+        sem_post(&sem_barbeiros[barbeiro]);
+        return;
+    }
 
-        pthread_mutex_unlock(&mutex);
-        pthread_exit(NULL);
+    for (int tentativas = 0; tentativas < num_salas; tentativas++)
+    {
+        if (sala_senta(&salas[sala], cliente))
+        {
+            //existe uma vaga nas cadeiras e o cliente conseguiu se sentar
+            LOG("Cliente %ld entrou na barbearia e se sentou em uma cadeira da fila %d.\n", cliente.id, sala);
+
+            sem_post(&sem_clientes); // Acorda um barbeiro, se houver algum dormindo
+            //um barbeiro pode ter entrado na pilha depois de retira_ocioso; ou ele ve a ficha ou ele e visto aqui
+            if (entrega_direta)
+            {
+                __atomic_thread_fence(__ATOMIC_SEQ_CST);
+                avisa_ocioso();
+            }
+            return;
+        }
+        if (++sala == num_salas)
+            sala = 0;
+    }
+
+    //se as cadeiras da fila de espera estiverem ocupadas o cliente vai embora
+    metricas_registra_desistente(&contadores->metricas, cliente.classe);
+    LOG("O cliente %ld não conseguiu se sentar e foi embora.\n", cliente.id);
+}
+
+
+//cada gerador cria os registros dos clientes e os coloca direto na fila, sem uma thread por cliente
+void *gerador(void *arg)
+{
+    contadores_t *contadores = arg;
+
+    while (1)
+    {
+        cliente_t cliente;
+        cliente.id = __atomic_fetch_add(&proximo_cliente_id, 1, __ATOMIC_RELAXED);
+        if (total_clientes > 0 && cliente.id >= total_clientes)
+            break;
+        cliente.classe = classe_sorteia(classes, num_classes, &contadores->aleatorio);
+        cliente.chegada = agora_ns();
+
+        despacha_cliente(cliente, contadores);
+
+        long espera_us = (long) distribuicao_amostra(&contadores->distribuicao, &contadores->aleatorio);
+        if (espera_us > 0)
+            usleep(espera_us);
+    }
+    return NULL;
+}
+
+
+void corta_cabelo(long duracao_us)
+{
+    if (duracao_us <= 0)
+        return;
+
+    if (corte_ocupado)
+    {
+        double fim = agora() + duracao_us / 1e6;
+        while (agora() < fim)
+            ;
     }
     else
     {
-        //existe uma vaga nas cadeiras e o cliente conseguiu se sentar
-        enfileirar_cliente(cliente_id);
+        usleep(duracao_us); //simulaçao do tempo do barbeiro cortando o cabelo
+    }
+}
+
 
-        printf("Cliente %d entrou na barbearia e se sentou em uma cadeira.\n", cliente_id);
+//chama um cliente da sala do barbeiro ou, se ela estiver vazia, de outra sala
+int proximo_cliente(contadores_t *contadores, cliente_t *cliente)
+{
+    int propria = contadores->id % num_salas;
+    if (sala_chama(&salas[propria], cliente))
+        return 1;
 
-        sem_post(&sem_cadeiras); // Libera uma cadeira
-        pthread_cond_signal(&cond_barbeiros); // Sinaliza que há um novo cliente na fila
+    int sala = propria;
+    for (int tentativas = 1; tentativas < num_salas; tentativas++)
+    {
+        if (++sala == num_salas)
+            sala = 0;
+        if (sala_chama(&salas[sala], cliente))
+        {
+            contadores->roubos++;
+            return 1;
+        }
     }
-    pthread_mutex_unlock(&mutex);
+    return 0;
+}
+
+
+//tira o barbeiro da pilha se ele ainda estiver nela; retorna 0 se um cliente ja o tirou
+int sai_da_pilha(int barbeiro)
+{
+    int saiu = 0;
 
-    pthread_exit(NULL);
+    pthread_mutex_lock(&trava_ociosos);
+    for (int i = num_ociosos - 1; i >= 0; i--)
+    {
+        if (ociosos[i] == barbeiro)
+        {
+            memmove(&ociosos[i], &ociosos[i + 1], (num_ociosos - 1 - i) * sizeof(int));
+            __atomic_store_n(&num_ociosos, num_ociosos - 1, __ATOMIC_SEQ_CST);
+            saiu = 1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&trava_ociosos);
+    return saiu;
 }
 
 
-void *barbeiro(void *id)
+//espera ate ter um cliente. retorna 1 se ele foi entregue direto em cliente, ou 0 se o barbeiro
+//pegou uma ficha de sem_clientes e deve chamar o cliente de uma sala. dormiu diz se ele dormiu antes
+int aguarda_cliente(int barbeiro_id, cliente_t *cliente, int *dormiu)
 {
-    int barbeiro_id = *(int *)id;
+    *dormiu = 0;
+    if (!entrega_direta)
+    {
+        if (sem_trywait(&sem_clientes) != 0)
+        {
+            //se nao existe (mais) nenhum cliente para ser atendido o barbeiro dorme
+            LOG("Barbeiro %d está dormindo.\n", barbeiro_id);
+            sem_wait(&sem_clientes);
+            *dormiu = 1;
+        }
+        return 0;
+    }
 
     while (1)
     {
-        pthread_mutex_lock(&mutex);
+        if (sem_trywait(&sem_clientes) == 0)
+            return 0;
 
-        while (frente_fila == fundo_fila)
+        pthread_mutex_lock(&trava_ociosos);
+        ociosos[num_ociosos] = barbeiro_id;
+        __atomic_store_n(&num_ociosos, num_ociosos + 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&trava_ociosos);
+
+        //um cliente pode ter sentado entre o sem_trywait e a pilha sem ver o barbeiro nela
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (sem_trywait(&sem_clientes) == 0)
         {
-            //se nao existe (mais) nenhum cliente para ser atendido o barbeiro dorme
-            printf("Barbeiro %d está dormindo.\n", barbeiro_id);
+            if (sai_da_pilha(barbeiro_id))
+                return 0;
+            //um cliente ja tirou este barbeiro da pilha e vai acorda-lo: devolve a ficha para outro
+            sem_post(&sem_clientes);
+            avisa_ocioso();
+        }
 
-            pthread_cond_wait(&cond_barbeiros, &mutex);
+        LOG("Barbeiro %d está dormindo.\n", barbeiro_id);
+        sem_wait(&sem_barbeiros[barbeiro_id]);
+        *dormiu = 1;
+        if (caixas[barbeiro_id].tem_cliente)
+        {
+            caixas[barbeiro_id].tem_cliente = 0;
+            *cliente = caixas[barbeiro_id].cliente;
+            return 1;
         }
+        //sem cliente na caixa: acordou para olhar as filas, ou para terminar
+    }
+}
 
-        int cliente_id = desenfileirar_cliente();
-        pthread_mutex_unlock(&mutex);
 
-        printf("Barbeiro %d está cortando o cabelo do cliente %d.\n", barbeiro_id, cliente_id);
-        sleep(3); //esse sleep 3 e uma simulaçao do tempo do barbeiro cortando o cabelo
+void *barbeiro(void *arg)
+{
+    contadores_t *contadores = arg;
+    int barbeiro_id = contadores->id;
 
-        sem_wait(&sem_cadeiras); //libera uma cadeira apos o corte do cabelo
+    while (1)
+    {
+        cliente_t cliente;
+        int dormiu;
+        int entregue = aguarda_cliente(barbeiro_id, &cliente, &dormiu);
+
+        //cada ficha do semaforo corresponde a um cliente ja sentado em alguma fila, mas o gerador
+        //dele pode ainda estar publicando a celula; so apos o fim das chegadas a fila vazia e definitiva
+        int encerrar = 0;
+        while (!entregue && !proximo_cliente(contadores, &cliente))
+        {
+            if (__atomic_load_n(&encerrando, __ATOMIC_ACQUIRE))
+            {
+                encerrar = 1;
+                break;
+            }
+            sched_yield();
+        }
+        if (encerrar)
+            break;
+
+        cliente.inicio = agora_ns();
+        if (dormiu)
+            histograma_registra(&contadores->metricas.despertar, cliente.inicio - cliente.sentou);
+        metricas_registra_espera(&contadores->metricas, cliente.classe, cliente.inicio - cliente.chegada,
+                                 cliente.prazo > 0 ? cliente.prazo - cliente.chegada : 0);
+
+        LOG("Barbeiro %d está cortando o cabelo do cliente %ld.\n", barbeiro_id, cliente.id);
+        corta_cabelo((long) distribuicao_amostra(&contadores->distribuicao, &contadores->aleatorio));
+
+        cliente.saida = agora_ns();
+        histograma_registra(&contadores->metricas.permanencia, cliente.saida - cliente.chegada);
+        contadores->metricas.ocupado[barbeiro_id] += (cliente.saida - cliente.inicio) / 1e9;
+        contadores->metricas.atendidos++;
     }
+    return NULL;
 }
 
-int main()
+
+//executa a barbearia com a configuracao atual ate os geradores terminarem e a fila esvaziar
+int executa_barbearia(resultado_t *resultado)
 {
-    pthread_t threads[NUM_BARBEIROS + NUM_CADEIRAS];
-    int ids[NUM_BARBEIROS + NUM_CADEIRAS];
+    pthread_t barbeiros[MAX_BARBEIROS];
+    pthread_t geradores[MAX_GERADORES];
+    contadores_t *contadores_barbeiros;
+    contadores_t *contadores_geradores;
+
+    //as cadeiras sao divididas entre as salas sem sobrar nem faltar; cada sala tem pelo menos uma,
+    //entao com menos cadeiras que barbeiros alguns barbeiros dividem a mesma sala
+    num_salas = filas_por_barbeiro ? num_barbeiros : 1;
+    if (num_salas > num_cadeiras)
+        num_salas = num_cadeiras;
+
+    if (posix_memalign((void **) &salas, TAMANHO_LINHA_CACHE, num_salas * sizeof(sala_t)) != 0 ||
+        posix_memalign((void **) &contadores_barbeiros, TAMANHO_LINHA_CACHE, num_barbeiros * sizeof(contadores_t)) != 0 ||
+        posix_memalign((void **) &contadores_geradores, TAMANHO_LINHA_CACHE, num_geradores * sizeof(contadores_t)) != 0)
+    {
+        perror("posix_memalign");
+        return -1;
+    }
+    for (int i = 0; i < num_salas; i++)
+    {
+        int cadeiras_sala = num_cadeiras / num_salas + (i < num_cadeiras % num_salas);
+        if (sala_inicia(&salas[i], cadeiras_sala, classes, num_classes, escalonamento) != 0)
+        {
+            perror("sala_inicia");
+            return -1;
+        }
+    }
+
+    //cada thread registra nas suas metricas; a soma e feita no fim
+    for (int i = 0; i < num_barbeiros + num_geradores; i++)
+    {
+        contadores_t *contadores = i < num_barbeiros ? &contadores_barbeiros[i] : &contadores_geradores[i - num_barbeiros];
+        memset(contadores, 0, sizeof(*contadores));
+        if (metricas_inicia(&contadores->metricas, num_barbeiros, num_cadeiras, num_classes) != 0)
+        {
+            perror("metricas_inicia");
+            return -1;
+        }
+    }
+    if (metricas_inicia(&resultado->metricas, num_barbeiros, num_cadeiras, num_classes) != 0)
+    {
+        perror("metricas_inicia");
+        return -1;
+    }
+
+    proximo_cliente_id = 0;
+    encerrando = 0;
+    num_ociosos = 0;
+    sem_init(&sem_clientes, 0, 0);
 
-    pthread_mutex_init(&mutex, NULL);
-    sem_init(&sem_cadeiras, 0, NUM_CADEIRAS);
+    struct rusage uso_inicio, uso_fim;
+    getrusage(RUSAGE_SELF, &uso_inicio);
 
-    for (int i = 0; i < NUM_BARBEIROS; i++)
+    for (int i = 0; i < num_barbeiros; i++)
     {
-        ids[i] = i;
-        sem_init(&sem_barbeiros[i], 0, 1);
-        pthread_create(&threads[i], NULL, barbeiro, &ids[i]);
+        contadores_barbeiros[i].id = i;
+        contadores_barbeiros[i].distribuicao = distribuicao_cortes;
+        contadores_barbeiros[i].distribuicao.media = tempo_corte_us;
+        aleatorio_semeia(&contadores_barbeiros[i].aleatorio, ~semente + i);
+        sem_init(&sem_barbeiros[i], 0, 0);
+        pthread_create(&barbeiros[i], NULL, barbeiro, &contadores_barbeiros[i]);
+        if (fixar_cpus)
+            fixa_cpu(barbeiros[i], i);
     }
 
-    //loop dos clientes
-    while (1)
+    //as chegadas vem de um conjunto fixo de geradores, criado uma vez so
+    double inicio = agora();
+    for (int i = 0; i < num_geradores; i++)
+    {
+        contadores_geradores[i].id = i;
+        contadores_geradores[i].proxima_sala = i % num_salas;
+        //com varios geradores cada um espera mais, para manter o intervalo total entre chegadas
+        contadores_geradores[i].distribuicao = distribuicao_chegadas;
+        contadores_geradores[i].distribuicao.media = (double) intervalo_chegada_us * num_geradores;
+        aleatorio_semeia(&contadores_geradores[i].aleatorio, semente + i);
+        pthread_create(&geradores[i], NULL, gerador, &contadores_geradores[i]);
+        if (fixar_cpus)
+            fixa_cpu(geradores[i], num_barbeiros + i);
+    }
+
+    for (int i = 0; i < num_geradores; i++)
+        pthread_join(geradores[i], NULL);
+    double fim_chegadas = agora();
+
+    //uma ficha extra por barbeiro: quem a pegar com a fila vazia termina
+    __atomic_store_n(&encerrando, 1, __ATOMIC_RELEASE);
+    for (int i = 0; i < num_barbeiros; i++)
+        sem_post(&sem_clientes);
+    if (entrega_direta)
+    {
+        //quem esta na pilha dorme no proprio semaforo; acordado, ele pega uma das fichas acima
+        while (avisa_ocioso())
+            ;
+    }
+
+    for (int i = 0; i < num_barbeiros; i++)
+        pthread_join(barbeiros[i], NULL);
+    double fim = agora();
+    getrusage(RUSAGE_SELF, &uso_fim);
+    resultado->trocas_voluntarias = uso_fim.ru_nvcsw - uso_inicio.ru_nvcsw;
+    resultado->trocas_involuntarias = uso_fim.ru_nivcsw - uso_inicio.ru_nivcsw;
+
+    resultado->roubos = 0;
+    resultado->entregas = 0;
+    for (int i = 0; i < num_barbeiros; i++)
     {
-        pthread_mutex_lock(&mutex);
+        metricas_soma(&resultado->metricas, &contadores_barbeiros[i].metricas);
+        metricas_libera(&contadores_barbeiros[i].metricas);
+        resultado->roubos += contadores_barbeiros[i].roubos;
+        sem_destroy(&sem_barbeiros[i]);
+    }
+    for (int i = 0; i < num_geradores; i++)
+    {
+        metricas_soma(&resultado->metricas, &contadores_geradores[i].metricas);
+        metricas_libera(&contadores_geradores[i].metricas);
+        resultado->entregas += contadores_geradores[i].entregas;
+    }
+    resultado->segundos_chegadas = fim_chegadas - inicio;
+    resultado->segundos_total = fim - inicio;
+
+    sem_destroy(&sem_clientes);
+    for (int i = 0; i < num_salas; i++)
+        sala_libera(&salas[i]);
+    free(salas);
+    free(contadores_barbeiros);
+    free(contadores_geradores);
+    return 0;
+}
+
+
+//repete a execucao dobrando o numero de barbeiros, com fila compartilhada e com filas por barbeiro
+int relatorio_escala(int max_barbeiros)
+{
+    if (total_clientes == 0)
+        total_clientes = 1000000;
+
+    printf("Escalabilidade: %ld clientes, %d gerador(es), corte de %ld us (%s), %d cadeiras, %d CPU(s)%s\n",
+           total_clientes, num_geradores, tempo_corte_us, corte_ocupado ? "ocupado" : "dormindo",
+           num_cadeiras, num_cpus, fixar_cpus ? ", threads fixadas" : "");
+    printf("%-10s %-14s %14s %12s %12s %10s\n", "barbeiros", "fila", "atendidos/s", "desistencia", "roubos", "tempo(s)");
 
-        int current_client_id = proximo_cliente_id++;
+    for (int barbeiros = 1; ; barbeiros *= 2)
+    {
+        if (barbeiros > max_barbeiros)
+            barbeiros = max_barbeiros;
 
-        pthread_mutex_unlock(&mutex);
-        pthread_create(&threads[NUM_BARBEIROS + current_client_id], NULL, cliente, &current_client_id);
+        for (int modo = 0; modo < 2; modo++)
+        {
+            resultado_t resultado;
+            num_barbeiros = barbeiros;
+            filas_por_barbeiro = modo;
+            if (executa_barbearia(&resultado) != 0)
+                return -1;
+
+            const metricas_t *metricas = &resultado.metricas;
+            printf("%-10d %-14s %14.0f %11.2f%% %12ld %10.3f\n", barbeiros, modo ? "por barbeiro" : "compartilhada",
+                   metricas->atendidos / resultado.segundos_total,
+                   100.0 * metricas->desistentes / (metricas->atendidos + metricas->desistentes),
+                   resultado.roubos, resultado.segundos_total);
+            metricas_libera(&resultado.metricas);
+
+            if (barbeiros == 1)
+                break; //com um barbeiro as duas filas sao a mesma
+        }
 
-        usleep(500000); //espera meio segundo para criar um novo cliente
+        if (barbeiros == max_barbeiros)
+            break;
     }
+    return 0;
+}
+
+
+//a mesma carga com os clientes sempre sentando (todos os barbeiros acordam por sem_clientes)
+//e com a entrega direta ao barbeiro que dormiu por ultimo
+int compara_entregas()
+{
+    if (total_clientes == 0)
+        total_clientes = 100000;
+
+    printf("Entrega direta: %ld clientes, %d barbeiros, %d gerador(es), intervalo %ld us, corte %ld us, %d CPU(s)\n",
+           total_clientes, num_barbeiros, num_geradores, intervalo_chegada_us, tempo_corte_us, num_cpus);
+    printf("%-8s %14s %14s %14s %14s %10s %14s %14s\n", "modo", "atendidos/s", "despertar p50", "despertar p99",
+           "espera p99", "entregas", "trocas vol.", "trocas invol.");
+
+    for (int modo = 0; modo < 2; modo++)
+    {
+        resultado_t resultado;
+        entrega_direta = modo;
+        if (executa_barbearia(&resultado) != 0)
+            return -1;
+
+        //tempos em us; trocas de contexto por cliente que chegou
+        const metricas_t *metricas = &resultado.metricas;
+        long chegadas = metricas->atendidos + metricas->desistentes;
+        printf("%-8s %14.0f %14.1f %14.1f %14.1f %9.1f%% %14.3f %14.3f\n", modo ? "direta" : "fila",
+               metricas->atendidos / resultado.segundos_total,
+               histograma_percentil(&metricas->despertar, 0.50) / 1e3,
+               histograma_percentil(&metricas->despertar, 0.99) / 1e3,
+               histograma_percentil(&metricas->espera, 0.99) / 1e3,
+               chegadas ? 100.0 * resultado.entregas / chegadas : 0.0,
+               chegadas ? (double) resultado.trocas_voluntarias / chegadas : 0.0,
+               chegadas ? (double) resultado.trocas_involuntarias / chegadas : 0.0);
+        metricas_libera(&resultado.metricas);
+    }
+    return 0;
+}
+
+
+//compara a execucao com a formula da M/M/c/K para as mesmas medias, barbeiros e cadeiras.
+//so e uma validacao com chegadas e cortes exponenciais; com outras distribuicoes e uma referencia
+void imprime_validacao(const metricas_t *metricas, double duracao, int espera_zero_exata)
+{
+    mmck_t teoria;
+    char chegadas[32], cortes[32];
 
-}
\ No newline at end of file
+    //com varias lojas cada uma recebe 1/lojas das chegadas; a comparacao so e exata no roteamento aleatorio
+    if (mmck_calcula(intervalo_chegada_us / 1e6 * num_lojas, tempo_corte_us / 1e6, num_barbeiros, num_cadeiras, &teoria) != 0)
+    {
+        printf("M/M/c/K: precisa de intervalo e corte maiores que zero\n");
+        return;
+    }
+
+    long chegadas_total = metricas->atendidos + metricas->desistentes;
+    double ocupado = 0;
+    for (int i = 0; i < metricas->barbeiros; i++)
+        ocupado += metricas->ocupado[i];
+
+    printf("Comparação com M/M/c/K (c = %d, K = %d%s), chegadas %s, cortes %s:\n", num_barbeiros,
+           num_barbeiros + num_cadeiras, num_lojas > 1 ? " em cada barbearia" : "", distribuicao_nome(&distribuicao_chegadas, chegadas, sizeof(chegadas)),
+           distribuicao_nome(&distribuicao_cortes, cortes, sizeof(cortes)));
+    printf("  %-26s %14s %14s %10s\n", "", "execução", "M/M/c/K", "diferença");
+
+    double simulado[5], analitico[5] = {100 * teoria.desistencia, teoria.espera_media, teoria.permanencia_media,
+                                        100 * teoria.prob_esperar, 100 * teoria.ocupacao};
+    const char *nomes[5] = {"desistência (%)", "espera média (s)", "permanência média (s)",
+                            "clientes que esperam (%)", "ocupação (%)"};
+    simulado[0] = chegadas_total ? 100.0 * metricas->desistentes / chegadas_total : 0;
+    simulado[1] = metricas->espera.contagem ? metricas->espera.soma / metricas->espera.contagem / 1e9 : 0;
+    simulado[2] = metricas->permanencia.contagem ? metricas->permanencia.soma / metricas->permanencia.contagem / 1e9 : 0;
+    simulado[3] = metricas->espera.contagem ?
+                  100.0 * (metricas->espera.contagem - metricas->espera.baldes[0]) / metricas->espera.contagem : 0;
+    simulado[4] = duracao > 0 ? 100 * ocupado / duracao / metricas->barbeiros : 0;
+
+    for (int i = 0; i < 5; i++)
+    {
+        //com threads ninguem espera exatamente 0 ns, entao essa linha so vale no tempo virtual
+        if (i == 3 && !espera_zero_exata)
+            continue;
+        printf("  %-26s %14.4f %14.4f %9.2f%%\n", nomes[i], simulado[i], analitico[i],
+               analitico[i] != 0 ? 100 * (simulado[i] - analitico[i]) / analitico[i] : 0.0);
+    }
+}
+
+
+//mesma barbearia em tempo virtual: segundos de execucao para horas de funcionamento
+int roda_simulacao(roteamento_t roteamento, escalonamento_t escalonamento, metricas_t *metricas,
+                   resultado_simulacao_t *resultado)
+{
+    config_simulacao_t config;
+
+    config.lojas = num_lojas;
+    config.roteamento = roteamento;
+    config.atualizacao_roteamento = atualizacao_roteamento_us / 1e6;
+    config.barbeiros = num_barbeiros;
+    config.cadeiras = num_cadeiras;
+    config.classes = classes;
+    config.num_classes = num_classes;
+    config.escalonamento = escalonamento;
+    config.chegadas = distribuicao_chegadas;
+    config.chegadas.media = intervalo_chegada_us / 1e6;
+    config.cortes = distribuicao_cortes;
+    config.cortes.media = tempo_corte_us / 1e6;
+    config.clientes = total_clientes > 0 ? total_clientes : 1000000;
+    config.semente = semente;
+    config.imprime_eventos = !silencioso;
+
+    if (metricas_inicia(metricas, num_lojas * num_barbeiros, num_cadeiras, num_classes) != 0 ||
+        simula_barbearia(&config, metricas, resultado) != 0)
+    {
+        perror("simula_barbearia");
+        return -1;
+    }
+    return 0;
+}
+
+
+//uma linha por politica de roteamento, todas com a mesma semente (as mesmas chegadas e cortes)
+int compara_roteamentos()
+{
+    printf("%d barbearias com %d barbeiros e %d cadeiras cada, tamanhos vistos pelo roteador a cada %ld us, semente %lu\n",
+           num_lojas, num_barbeiros, num_cadeiras, atualizacao_roteamento_us, semente);
+    printf("%-10s %12s %12s %12s %12s %14s %10s\n", "roteamento", "desistencia", "espera p50", "espera p99",
+           "espera p99.9", "permanência p99", "ocupação");
+
+    for (int politica = 0; politica < NUM_ROTEAMENTOS; politica++)
+    {
+        metricas_t metricas;
+        resultado_simulacao_t resultado;
+        if (roda_simulacao((roteamento_t) politica, escalonamento, &metricas, &resultado) != 0)
+            return -1;
+
+        long chegadas = metricas.atendidos + metricas.desistentes;
+        double ocupado = 0;
+        for (int i = 0; i < metricas.barbeiros; i++)
+            ocupado += metricas.ocupado[i];
+
+        //tempos em segundos
+        printf("%-10s %11.3f%% %12.3f %12.3f %12.3f %14.3f %9.2f%%\n", roteamento_nome((roteamento_t) politica),
+               chegadas ? 100.0 * metricas.desistentes / chegadas : 0.0,
+               histograma_percentil(&metricas.espera, 0.50) / 1e9, histograma_percentil(&metricas.espera, 0.99) / 1e9,
+               histograma_percentil(&metricas.espera, 0.999) / 1e9,
+               histograma_percentil(&metricas.permanencia, 0.99) / 1e9,
+               resultado.tempo_virtual > 0 ? 100 * ocupado / resultado.tempo_virtual / metricas.barbeiros : 0.0);
+        metricas_libera(&metricas);
+    }
+    return 0;
+}
+
+
+//uma linha por classe em cada escalonamento, todos com a mesma semente
+int compara_escalonamentos()
+{
+    printf("%d barbeiros, %d cadeiras, %d classes, semente %lu\n", num_barbeiros, num_cadeiras, num_classes, semente);
+    for (int i = 0; i < num_classes; i++)
+    {
+        printf("  classe %d: %.1f%% das chegadas, peso %g, ", i, 100 * classes[i].fracao, classes[i].peso);
+        if (classes[i].prazo > 0)
+            printf("prazo de %.3f ms\n", classes[i].prazo / 1e6);
+        else
+            printf("sem prazo\n");
+    }
+    printf("%-13s %-7s %12s %12s %12s %12s %12s %14s\n", "escalonamento", "classe", "desistencia", "espera p50",
+           "espera p99", "espera p99.9", "atendimentos", "prazo perdido");
+
+    for (int politica = 0; politica < NUM_ESCALONAMENTOS; politica++)
+    {
+        metricas_t metricas;
+        resultado_simulacao_t resultado;
+        if (roda_simulacao(roteamento, (escalonamento_t) politica, &metricas, &resultado) != 0)
+            return -1;
+
+        //tempos em segundos; atendimentos e a parte de cada classe nos cortes
+        for (int i = 0; i < num_classes; i++)
+        {
+            const metricas_classe_t *classe = &metricas.classe[i];
+            long chegadas = (long) classe->espera.contagem + classe->desistentes;
+            printf("%-13s %-7d %11.3f%% %12.3f %12.3f %12.3f %11.2f%%", escalonamento_nome((escalonamento_t) politica), i,
+                   chegadas ? 100.0 * classe->desistentes / chegadas : 0.0,
+                   histograma_percentil(&classe->espera, 0.50) / 1e9, histograma_percentil(&classe->espera, 0.99) / 1e9,
+                   histograma_percentil(&classe->espera, 0.999) / 1e9,
+                   metricas.atendidos ? 100.0 * classe->espera.contagem / metricas.atendidos : 0.0);
+            if (classe->com_prazo > 0)
+                printf(" %13.2f%%\n", 100.0 * classe->prazos_perdidos / classe->com_prazo);
+            else
+                printf(" %14s\n", "-");
+        }
+        metricas_libera(&metricas);
+    }
+    return 0;
+}
+
+
+int simulacao_virtual()
+{
+    resultado_simulacao_t resultado;
+    metricas_t metricas;
+
+    if (comparar_roteamentos)
+        return compara_roteamentos();
+    if (comparar_escalonamentos)
+        return compara_escalonamentos();
+
+    double inicio = agora();
+    if (roda_simulacao(roteamento, escalonamento, &metricas, &resultado) != 0)
+        return -1;
+    double segundos = agora() - inicio;
+
+    long chegadas = metricas.atendidos + metricas.desistentes;
+    printf("\nSimulação em tempo virtual, semente %lu: %d barbeiros, %d cadeiras", semente, num_barbeiros, num_cadeiras);
+    if (num_lojas > 1)
+        printf(" em cada uma de %d barbearias, roteamento %s", num_lojas, roteamento_nome(roteamento));
+    if (num_classes > 1)
+        printf(", %d classes com escalonamento %s", num_classes, escalonamento_nome(escalonamento));
+    printf("\n");
+    metricas_imprime(&metricas, resultado.tempo_virtual);
+    if (validar)
+        imprime_validacao(&metricas, resultado.tempo_virtual, 1);
+    printf("Tempo virtual: %.1f s (%.2f h)\n", resultado.tempo_virtual, resultado.tempo_virtual / 3600);
+    printf("Tempo real: %.3f s, %.0f clientes/s, %.0f eventos/s\n", segundos, chegadas / segundos,
+           resultado.eventos / segundos);
+
+    metricas_libera(&metricas);
+    return 0;
+}
+
+
+void uso(const char *programa)
+{
+    fprintf(stderr,
+            "Uso: %s [-b barbeiros] [-C cadeiras] [-g geradores] [-i intervalo_us] [-c corte_us] [-n clientes]\n"
+            "          [-a distribuição] [-d distribuição] [-f] [-p] [-o] [-E] [-S] [-s semente] [-M]\n"
+            "          [-L barbearias] [-R roteamento] [-A atualização_us] [-K classes] [-P escalonamento]\n"
+            "          [-H entrega] [-q]\n"
+            "  -b  barbeiros (padrão %d, 0 = um por CPU, máximo %d)\n"
+            "  -C  cadeiras de espera (padrão %d)\n"
+            "  -g  threads geradoras de clientes (padrão 1, máximo %d)\n"
+            "  -i  intervalo entre chegadas em microssegundos (padrão 500000, 0 = sem espera)\n"
+            "  -c  tempo médio de cada corte em microssegundos (padrão 3000000)\n"
+            "  -a  distribuição dos intervalos entre chegadas (padrão det; -S usa exp)\n"
+            "  -d  distribuição dos tempos de corte (padrão det; -S usa exp)\n"
+            "      exp, det, mmpp[:razão da rajada], pareto[:forma], lognormal[:desvio do log]\n"
+            "  -n  número de clientes; 0 gera para sempre (padrão)\n"
+            "  -f  uma fila por barbeiro, com roubo de clientes entre as filas (no máximo uma por cadeira)\n"
+            "  -p  fixa cada barbeiro e gerador em uma CPU\n"
+            "  -o  o corte ocupa a CPU em vez de dormir\n"
+            "  -E  relatório de escalabilidade de 1 até -b barbeiros (padrão: todas as CPUs);\n"
+            "      -n padrão de 1000000 clientes, -i e -c padrão 0\n"
+            "  -S  simulação em tempo virtual (eventos discretos); -n padrão de 1000000 clientes\n"
+            "  -s  semente das distribuições (padrão 1)\n"
+            "  -M  compara desistência, espera e ocupação com a fila M/M/c/K\n"
+            "  -L  barbearias independentes, cada uma com -b barbeiros e -C cadeiras (só com -S);\n"
+            "      -i passa a ser o intervalo entre chegadas no roteador\n"
+            "  -R  roteamento entre as barbearias: aleatorio, rodizio, jsq, p2c ou todos (compara)\n"
+            "  -A  de quanto em quanto tempo virtual o roteador vê o tamanho das filas, em us (padrão 0 = sempre)\n"
+            "  -K  classes de clientes, da mais urgente para a menos: fração[:peso[:prazo_us]],...\n"
+            "      o prazo é a espera máxima até o início do corte (padrão: uma classe, sem prazo; máximo %d)\n"
+            "  -P  escalonamento das cadeiras: fifo (padrão), prioridade, wfq, edf ou todos (compara, só com -S)\n"
+            "  -H  entrega dos clientes: fila (padrão, sempre sentam e acordam um barbeiro por sem_clientes),\n"
+            "      direta (passam direto a um barbeiro dormindo, acordado no seu semáforo) ou todos (compara;\n"
+            "      -n padrão de 100000 clientes, -i e -c padrão 0)\n"
+            "  -q  não imprime os eventos, só o resumo\n",
+            programa, NUM_BARBEIROS, MAX_BARBEIROS, NUM_CADEIRAS, MAX_GERADORES, MAX_CLASSES);
+}
+
+
+int main(int argc, char *argv[])
+{
+    int opcao;
+    int escala = 0;
+    int barbeiros_informados = 0;
+    int distribuicao_informada = 0;
+    int tempos_informados = 0;
+
+    num_cpus = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_cpus < 1)
+        num_cpus = 1;
+
+    while ((opcao = getopt(argc, argv, "b:C:g:i:c:n:a:d:fpoESs:ML:R:A:K:P:H:q")) != -1)
+    {
+        switch (opcao)
+        {
+            case 'b': num_barbeiros = atoi(optarg); barbeiros_informados = 1; break;
+            case 'C': num_cadeiras = atoi(optarg); break;
+            case 'g': num_geradores = atoi(optarg); break;
+            case 'i': intervalo_chegada_us = atol(optarg); tempos_informados |= 1; break;
+            case 'c': tempo_corte_us = atol(optarg); tempos_informados |= 2; break;
+            case 'n': total_clientes = atol(optarg); break;
+            case 'f': filas_por_barbeiro = 1; break;
+            case 'p': fixar_cpus = 1; break;
+            case 'o': corte_ocupado = 1; break;
+            case 'E': escala = 1; break;
+            case 'a':
+                if (distribuicao_le(&distribuicao_chegadas, optarg) != 0)
+                {
+                    uso(argv[0]);
+                    return 1;
+                }
+                distribuicao_informada |= 1;
+                break;
+            case 'd':
+                if (distribuicao_le(&distribuicao_cortes, optarg) != 0)
+                {
+                    uso(argv[0]);
+                    return 1;
+                }
+                distribuicao_informada |= 2;
+                break;
+            case 'M': validar = 1; break;
+            case 'L': num_lojas = atoi(optarg); break;
+            case 'R':
+                if (strcmp(optarg, "todos") == 0)
+                    comparar_roteamentos = 1;
+                else if (roteamento_por_nome(optarg) >= 0)
+                    roteamento = (roteamento_t) roteamento_por_nome(optarg);
+                else
+                {
+                    uso(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'A': atualizacao_roteamento_us = atol(optarg); break;
+            case 'K':
+                num_classes = classes_le(classes, optarg);
+                if (num_classes < 1)
+                {
+                    uso(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'P':
+                if (strcmp(optarg, "todos") == 0)
+                    comparar_escalonamentos = 1;
+                else if (escalonamento_por_nome(optarg) >= 0)
+                    escalonamento = (escalonamento_t) escalonamento_por_nome(optarg);
+                else
+                {
+                    uso(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'H':
+                if (strcmp(optarg, "todos") == 0)
+                    comparar_entregas = 1;
+                else if (strcmp(optarg, "direta") == 0 || strcmp(optarg, "fila") == 0)
+                    entrega_direta = strcmp(optarg, "direta") == 0;
+                else
+                {
+                    uso(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'S': tempo_virtual = 1; break;
+            case 's': semente = strtoul(optarg, NULL, 10); break;
+            case 'q': silencioso = 1; break;
+            default: uso(argv[0]); return 1;
+        }
+    }
+    if (num_barbeiros == 0 || (escala && !barbeiros_informados))
+        num_barbeiros = num_cpus < MAX_BARBEIROS ? num_cpus : MAX_BARBEIROS;
+    if (num_barbeiros < 1 || num_barbeiros > MAX_BARBEIROS || num_cadeiras < 1 ||
+        num_geradores < 1 || num_geradores > MAX_GERADORES || intervalo_chegada_us < 0 ||
+        tempo_corte_us < 0 || total_clientes < 0 || num_lojas < 1 || atualizacao_roteamento_us < 0)
+    {
+        uso(argv[0]);
+        return 1;
+    }
+    if (!tempo_virtual && (num_lojas > 1 || comparar_roteamentos))
+    {
+        fprintf(stderr, "Várias barbearias (-L, -R) só existem na simulação em tempo virtual (-S).\n");
+        return 1;
+    }
+    if (!tempo_virtual && comparar_escalonamentos)
+    {
+        fprintf(stderr, "A comparação dos escalonamentos (-P todos) só existe na simulação em tempo virtual (-S).\n");
+        return 1;
+    }
+    if (tempo_virtual && (entrega_direta || comparar_entregas))
+    {
+        fprintf(stderr, "A entrega direta (-H) só existe na versão com threads.\n");
+        return 1;
+    }
+
+    //o tempo virtual existe para experimentos de capacidade, entao o padrao e o modelo de Poisson
+    if (tempo_virtual && !(distribuicao_informada & 1))
+        distribuicao_chegadas.tipo = DISTRIBUICAO_EXPONENCIAL;
+    if (tempo_virtual && !(distribuicao_informada & 2))
+        distribuicao_cortes.tipo = DISTRIBUICAO_EXPONENCIAL;
+
+    if (tempo_virtual)
+        return simulacao_virtual() == 0 ? 0 : 1;
+
+    //os relatorios rodam com muitos clientes: com os tempos padrao levariam dias
+    if ((escala || comparar_entregas) && !(tempos_informados & 1))
+        intervalo_chegada_us = 0;
+    if ((escala || comparar_entregas) && !(tempos_informados & 2))
+        tempo_corte_us = 0;
+
+    if (escala)
+    {
+        silencioso = 1;
+        return relatorio_escala(num_barbeiros) == 0 ? 0 : 1;
+    }
+    if (comparar_entregas)
+    {
+        silencioso = 1;
+        return compara_entregas() == 0 ? 0 : 1;
+    }
+
+    resultado_t resultado;
+    if (executa_barbearia(&resultado) != 0)
+        return 1;
+
+    const metricas_t *metricas = &resultado.metricas;
+    long chegadas = metricas->atendidos + metricas->desistentes;
+    printf("\n");
+    metricas_imprime(metricas, resultado.segundos_total);
+    if (validar)
+        imprime_validacao(metricas, resultado.segundos_total, 0);
+    printf("Chegadas: %.3f s com %d gerador(es), %.0f clientes/s\n", resultado.segundos_chegadas, num_geradores,
+           chegadas / resultado.segundos_chegadas);
+    printf("Barbeiros: %d, %s, %.0f atendimentos/s", num_barbeiros,
+           filas_por_barbeiro ? "uma fila por barbeiro" : "fila compartilhada",
+           metricas->atendidos / resultado.segundos_total);
+    if (filas_por_barbeiro)
+        printf(", %ld roubos (%.1f%%)", resultado.roubos,
+               metricas->atendidos ? 100.0 * resultado.roubos / metricas->atendidos : 0.0);
+    if (entrega_direta)
+        printf(", %ld entregas diretas (%.1f%%)", resultado.entregas, chegadas ? 100.0 * resultado.entregas / chegadas : 0.0);
+    printf("\nTrocas de contexto: %ld voluntárias, %ld involuntárias (%.3f por cliente)", resultado.trocas_voluntarias,
+           resultado.trocas_involuntarias,
+           chegadas ? (double) (resultado.trocas_voluntarias + resultado.trocas_involuntarias) / chegadas : 0.0);
+    printf("\nTempo total: %.3f s\n", resultado.segundos_total);
+
+    metricas_libera(&resultado.metricas);
+
+    return 0;
+}
@@ -0,0 +1,169 @@
+#include "metricas.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//maior valor que cai no balde, como o highestEquivalentValue do HdrHistogram
+static uint64_t valor_balde(int balde)
+{
+    if (balde < 2 * HISTOGRAMA_SUBBALDES)
+        return (uint64_t) balde;
+    int deslocamento = balde / HISTOGRAMA_SUBBALDES - 1;
+    uint64_t sub = (uint64_t) (balde - deslocamento * HISTOGRAMA_SUBBALDES);
+    return ((sub + 1) << deslocamento) - 1;
+}
+
+
+uint64_t histograma_percentil(const histograma_t *histograma, double p)
+{
+    if (histograma->contagem == 0)
+        return 0;
+
+    uint64_t alvo = (uint64_t) (p * histograma->contagem + 0.5);
+    if (alvo < 1)
+        alvo = 1;
+
+    uint64_t acumulado = 0;
+    for (int i = 0; i < HISTOGRAMA_BALDES; i++)
+    {
+        acumulado += histograma->baldes[i];
+        if (acumulado >= alvo)
+        {
+            uint64_t valor = valor_balde(i);
+            return valor < histograma->maximo ? valor : histograma->maximo;
+        }
+    }
+    return histograma->maximo;
+}
+
+
+void histograma_soma(histograma_t *destino, const histograma_t *origem)
+{
+    for (int i = 0; i < HISTOGRAMA_BALDES; i++)
+        destino->baldes[i] += origem->baldes[i];
+    destino->contagem += origem->contagem;
+    destino->soma += origem->soma;
+    if (origem->maximo > destino->maximo)
+        destino->maximo = origem->maximo;
+}
+
+
+int metricas_inicia(metricas_t *metricas, int barbeiros, int cadeiras, int classes)
+{
+    memset(metricas, 0, sizeof(*metricas));
+    metricas->barbeiros = barbeiros;
+    metricas->cadeiras = cadeiras;
+    metricas->fila_vista = calloc(cadeiras + 1, sizeof(long));
+    metricas->ocupado = calloc(barbeiros, sizeof(double));
+    metricas->classes = classes;
+    metricas->classe = calloc(classes, sizeof(metricas_classe_t));
+    if (metricas->fila_vista == NULL || metricas->ocupado == NULL || metricas->classe == NULL)
+    {
+        metricas_libera(metricas);
+        return -1;
+    }
+    return 0;
+}
+
+
+void metricas_soma(metricas_t *destino, const metricas_t *origem)
+{
+    destino->atendidos += origem->atendidos;
+    destino->desistentes += origem->desistentes;
+    histograma_soma(&destino->espera, &origem->espera);
+    histograma_soma(&destino->permanencia, &origem->permanencia);
+    histograma_soma(&destino->despertar, &origem->despertar);
+    for (int i = 0; i <= destino->cadeiras && i <= origem->cadeiras; i++)
+        destino->fila_vista[i] += origem->fila_vista[i];
+    for (int i = 0; i < destino->barbeiros && i < origem->barbeiros; i++)
+        destino->ocupado[i] += origem->ocupado[i];
+    for (int i = 0; i < destino->classes && i < origem->classes; i++)
+    {
+        destino->classe[i].desistentes += origem->classe[i].desistentes;
+        histograma_soma(&destino->classe[i].espera, &origem->classe[i].espera);
+        destino->classe[i].com_prazo += origem->classe[i].com_prazo;
+        destino->classe[i].prazos_perdidos += origem->classe[i].prazos_perdidos;
+    }
+}
+
+
+void metricas_libera(metricas_t *metricas)
+{
+    free(metricas->fila_vista);
+    free(metricas->ocupado);
+    free(metricas->classe);
+    metricas->fila_vista = NULL;
+    metricas->ocupado = NULL;
+    metricas->classe = NULL;
+}
+
+
+static void imprime_histograma(const char *nome, const histograma_t *histograma)
+{
+    //os registros estao em ns, o relatorio em ms
+    printf("%-28s %12.3f %12.3f %12.3f %12.3f %12.3f\n", nome,
+           histograma->contagem ? histograma->soma / histograma->contagem / 1e6 : 0.0,
+           histograma_percentil(histograma, 0.50) / 1e6,
+           histograma_percentil(histograma, 0.99) / 1e6,
+           histograma_percentil(histograma, 0.999) / 1e6,
+           histograma->maximo / 1e6);
+}
+
+
+void metricas_imprime(const metricas_t *metricas, double duracao)
+{
+    long chegadas = metricas->atendidos + metricas->desistentes;
+    printf("Clientes: %ld (atendidos %ld, desistentes %ld = %.2f%%)\n", chegadas, metricas->atendidos,
+           metricas->desistentes, chegadas ? 100.0 * metricas->desistentes / chegadas : 0.0);
+
+    printf("%-28s %12s %12s %12s %12s %12s\n", "tempos (ms)", "média", "p50", "p99", "p99.9", "máximo");
+    imprime_histograma("espera nas cadeiras", &metricas->espera);
+    imprime_histograma("permanência na barbearia", &metricas->permanencia);
+    if (metricas->despertar.contagem > 0)
+        imprime_histograma("despertar do barbeiro", &metricas->despertar);
+
+    long observacoes = 0;
+    for (int i = 0; i <= metricas->cadeiras; i++)
+        observacoes += metricas->fila_vista[i];
+    printf("Clientes esperando vistos na chegada:");
+    for (int i = 0; i <= metricas->cadeiras; i++)
+    {
+        if (i % 8 == 0)
+            printf("\n ");
+        printf(" %3d: %6.2f%%", i, observacoes ? 100.0 * metricas->fila_vista[i] / observacoes : 0.0);
+    }
+
+    double total = 0;
+    printf("\nOcupação dos barbeiros:");
+    for (int i = 0; i < metricas->barbeiros; i++)
+    {
+        if (i % 8 == 0)
+            printf("\n ");
+        printf(" %3d: %6.2f%%", i, duracao > 0 ? 100.0 * metricas->ocupado[i] / duracao : 0.0);
+        total += metricas->ocupado[i];
+    }
+    printf("\n  média: %.2f%%\n", duracao > 0 && metricas->barbeiros ? 100.0 * total / duracao / metricas->barbeiros : 0.0);
+
+    long com_prazo = 0;
+    for (int i = 0; i < metricas->classes; i++)
+        com_prazo += metricas->classe[i].com_prazo;
+    if (metricas->classes < 2 && com_prazo == 0)
+        return;
+
+    printf("%-8s %12s %12s %12s %12s %12s %14s\n", "classe", "atendidos", "desistência", "p50 (ms)", "p99 (ms)",
+           "p99.9 (ms)", "prazo perdido");
+    for (int i = 0; i < metricas->classes; i++)
+    {
+        const metricas_classe_t *classe = &metricas->classe[i];
+        long chegadas_classe = (long) classe->espera.contagem + classe->desistentes;
+        printf("%-8d %12ld %11.2f%% %12.3f %12.3f %12.3f", i, (long) classe->espera.contagem,
+               chegadas_classe ? 100.0 * classe->desistentes / chegadas_classe : 0.0,
+               histograma_percentil(&classe->espera, 0.50) / 1e6, histograma_percentil(&classe->espera, 0.99) / 1e6,
+               histograma_percentil(&classe->espera, 0.999) / 1e6);
+        if (classe->com_prazo > 0)
+            printf(" %13.2f%%\n", 100.0 * classe->prazos_perdidos / classe->com_prazo);
+        else
+            printf(" %14s\n", "-");
+    }
+}
@@ -0,0 +1,103 @@
+/*
+  Medidas de latencia e ocupacao da barbearia.
+  Os tempos vao para histogramas em baldes logaritmicos no estilo do HdrHistogram:
+  cada potencia de 2 e dividida em HISTOGRAMA_SUBBALDES baldes lineares, entao o erro
+  relativo fica abaixo de 1/64 em toda a faixa, de nanossegundos a anos, sem alocar nada.
+  Cada thread (ou a simulacao) preenche as suas metricas e no fim elas sao somadas.
+  A espera e as desistencias tambem sao separadas por classe de cliente, com os prazos perdidos.
+ */
+
+#ifndef METRICAS_H
+#define METRICAS_H
+
+#include <stdint.h>
+
+#define HISTOGRAMA_BITS_SUBBALDES 6
+#define HISTOGRAMA_SUBBALDES (1 << HISTOGRAMA_BITS_SUBBALDES)
+#define HISTOGRAMA_BALDES ((64 - HISTOGRAMA_BITS_SUBBALDES + 1) * HISTOGRAMA_SUBBALDES)
+
+typedef struct
+{
+    uint64_t contagem;
+    uint64_t maximo;
+    double soma;
+    uint64_t baldes[HISTOGRAMA_BALDES];
+} histograma_t;
+
+typedef struct
+{
+    long desistentes;
+    histograma_t espera; //atendidos da classe
+    long com_prazo; //atendidos que tinham prazo
+    long prazos_perdidos; //comecaram o corte depois do prazo
+} metricas_classe_t;
+
+typedef struct
+{
+    long atendidos;
+    long desistentes;
+    histograma_t espera; //da chegada ao inicio do corte, em ns
+    histograma_t permanencia; //da chegada a saida, em ns
+    histograma_t despertar; //de quando o cliente sentou (ou foi entregue) ao corte, so para barbeiros que dormiam
+    int cadeiras;
+    long *fila_vista; //fila_vista[k]: chegadas que encontraram k clientes esperando (k = 0..cadeiras)
+    int barbeiros;
+    double *ocupado; //segundos cortando cabelo de cada barbeiro
+    int classes;
+    metricas_classe_t *classe; //o mesmo por classe de cliente
+} metricas_t;
+
+static inline int histograma_balde(uint64_t valor)
+{
+    if (valor < 2 * HISTOGRAMA_SUBBALDES)
+        return (int) valor;
+    int deslocamento = 63 - __builtin_clzll(valor) - HISTOGRAMA_BITS_SUBBALDES;
+    return (deslocamento + 1) * HISTOGRAMA_SUBBALDES + (int) (valor >> deslocamento) - HISTOGRAMA_SUBBALDES;
+}
+
+static inline void histograma_registra(histograma_t *histograma, uint64_t valor)
+{
+    histograma->baldes[histograma_balde(valor)]++;
+    histograma->contagem++;
+    histograma->soma += (double) valor;
+    if (valor > histograma->maximo)
+        histograma->maximo = valor;
+}
+
+//espera de um cliente atendido; prazo e quanto ele aceitava esperar, em ns (0 = sem prazo)
+static inline void metricas_registra_espera(metricas_t *metricas, int classe, uint64_t espera, uint64_t prazo)
+{
+    metricas_classe_t *metricas_classe = &metricas->classe[classe];
+    histograma_registra(&metricas->espera, espera);
+    histograma_registra(&metricas_classe->espera, espera);
+    if (prazo > 0)
+    {
+        metricas_classe->com_prazo++;
+        if (espera > prazo)
+            metricas_classe->prazos_perdidos++;
+    }
+}
+
+static inline void metricas_registra_desistente(metricas_t *metricas, int classe)
+{
+    metricas->desistentes++;
+    metricas->classe[classe].desistentes++;
+}
+
+//menor valor v tal que pelo menos a fracao p (0..1) dos registros e <= v, com a precisao do balde
+uint64_t histograma_percentil(const histograma_t *histograma, double p);
+
+void histograma_soma(histograma_t *destino, const histograma_t *origem);
+
+//retorna 0 ou -1 se faltar memoria
+int metricas_inicia(metricas_t *metricas, int barbeiros, int cadeiras, int classes);
+
+void metricas_soma(metricas_t *destino, const metricas_t *origem);
+
+void metricas_libera(metricas_t *metricas);
+
+//imprime desistencias, percentis de espera e permanencia, fila vista nas chegadas e ocupacao
+//dos barbeiros, e com varias classes ou prazos uma linha por classe; duracao e o tempo (real ou virtual) usado para calcular a ocupacao
+void metricas_imprime(const metricas_t *metricas, double duracao);
+
+#endif
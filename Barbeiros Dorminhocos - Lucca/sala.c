@@ -0,0 +1,242 @@
+#include "sala.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//passe que uma classe de peso 1 anda a cada atendimento no wfq
+#define PASSE_BASE 1000000.0
+
+static const char *nomes[NUM_ESCALONAMENTOS] = {"fifo", "prioridade", "wfq", "edf"};
+
+int escalonamento_por_nome(const char *nome)
+{
+    for (int i = 0; i < NUM_ESCALONAMENTOS; i++)
+    {
+        if (strcmp(nome, nomes[i]) == 0)
+            return i;
+    }
+    return -1;
+}
+
+
+const char *escalonamento_nome(escalonamento_t escalonamento)
+{
+    return nomes[escalonamento];
+}
+
+
+int classes_le(classe_t *classes, const char *texto)
+{
+    classe_t lidas[MAX_CLASSES];
+    int num_classes = 0;
+    double soma = 0;
+    const char *inicio = texto;
+
+    while (1)
+    {
+        char *fim;
+        if (num_classes == MAX_CLASSES)
+            return -1;
+
+        classe_t classe = {strtod(inicio, &fim), 1, 0};
+        if (fim == inicio)
+            return -1;
+        if (*fim == ':')
+        {
+            inicio = fim + 1;
+            classe.peso = strtod(inicio, &fim);
+            if (fim == inicio)
+                return -1;
+        }
+        if (*fim == ':')
+        {
+            inicio = fim + 1;
+            double prazo_us = strtod(inicio, &fim);
+            if (fim == inicio || prazo_us < 0)
+                return -1;
+            classe.prazo = (uint64_t) (prazo_us * 1000);
+        }
+        if (classe.fracao < 0 || classe.peso <= 0)
+            return -1;
+
+        lidas[num_classes++] = classe;
+        soma += classe.fracao;
+        if (*fim == '\0')
+            break;
+        if (*fim != ',')
+            return -1;
+        inicio = fim + 1;
+    }
+    if (soma <= 0)
+        return -1;
+
+    for (int i = 0; i < num_classes; i++)
+    {
+        classes[i] = lidas[i];
+        classes[i].fracao /= soma;
+    }
+    return num_classes;
+}
+
+
+int classe_sorteia(const classe_t *classes, int num_classes, aleatorio_t *gerador)
+{
+    if (num_classes == 1)
+        return 0;
+
+    double sorteio = aleatorio_uniforme(gerador);
+    double acumulado = 0;
+    for (int i = 0; i < num_classes - 1; i++)
+    {
+        acumulado += classes[i].fracao;
+        if (sorteio <= acumulado)
+            return i;
+    }
+    return num_classes - 1;
+}
+
+
+uint64_t classe_prazo(const classe_t *classe, uint64_t chegada)
+{
+    return classe->prazo > 0 ? chegada + classe->prazo : 0;
+}
+
+
+int sala_inicia(sala_t *sala, int cadeiras, const classe_t *classes, int num_classes, escalonamento_t escalonamento)
+{
+    memset(sala, 0, sizeof(*sala));
+    sala->num_classes = num_classes;
+    sala->escalonamento = escalonamento;
+    sala->cadeiras = cadeiras;
+
+    //cada fila tem todas as cadeiras, porque qualquer classe pode ocupa-las
+    for (int i = 0; i < num_classes; i++)
+    {
+        sala->classes[i] = classes[i];
+        if (fila_inicia(&sala->filas[i], cadeiras) != 0)
+        {
+            sala_libera(sala);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+
+void sala_libera(sala_t *sala)
+{
+    for (int i = 0; i < sala->num_classes; i++)
+        fila_libera(&sala->filas[i]);
+}
+
+
+int sala_senta(sala_t *sala, cliente_t cliente)
+{
+    int classe = cliente.classe;
+    cliente.prazo = classe_prazo(&sala->classes[classe], cliente.chegada);
+
+    if (sala->num_classes == 1)
+        return fila_enfileira(&sala->filas[0], cliente);
+
+    if (__atomic_add_fetch(&sala->ocupadas, 1, __ATOMIC_RELAXED) > sala->cadeiras)
+    {
+        __atomic_sub_fetch(&sala->ocupadas, 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+
+    if (sala->escalonamento == ESCALONAMENTO_WFQ && fila_tamanho(&sala->filas[classe]) == 0)
+    {
+        //a classe estava sem clientes: nao acumula credito pelo tempo que ficou parada
+        uint64_t atual = __atomic_load_n(&sala->passe_atual, __ATOMIC_RELAXED);
+        if (__atomic_load_n(&sala->passes[classe], __ATOMIC_RELAXED) < atual)
+            __atomic_store_n(&sala->passes[classe], atual, __ATOMIC_RELAXED);
+    }
+
+    if (!fila_enfileira(&sala->filas[classe], cliente))
+    {
+        //a cadeira foi reservada, mas quem saiu dela ainda esta terminando de levantar
+        __atomic_sub_fetch(&sala->ocupadas, 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+    return 1;
+}
+
+
+//classe de onde o escalonamento quer tirar o proximo cliente, ou -1 para ir em ordem de classe
+static int escolhe_classe(sala_t *sala)
+{
+    int escolhida = -1;
+
+    if (sala->escalonamento == ESCALONAMENTO_PRIORIDADE)
+        return -1;
+
+    if (sala->escalonamento == ESCALONAMENTO_WFQ)
+    {
+        uint64_t menor = 0;
+        for (int i = 0; i < sala->num_classes; i++)
+        {
+            uint64_t passe = __atomic_load_n(&sala->passes[i], __ATOMIC_RELAXED);
+            if (fila_tamanho(&sala->filas[i]) > 0 && (escolhida < 0 || passe < menor))
+            {
+                escolhida = i;
+                menor = passe;
+            }
+        }
+        return escolhida;
+    }
+
+    //fifo e edf olham a frente de cada fila; sem prazos o edf vira fifo
+    uint64_t menor_prazo = 0, menor_chegada = 0;
+    for (int i = 0; i < sala->num_classes; i++)
+    {
+        cliente_t frente;
+        if (!fila_espia(&sala->filas[i], &frente))
+            continue;
+
+        uint64_t prazo = sala->escalonamento == ESCALONAMENTO_EDF && frente.prazo > 0 ? frente.prazo : UINT64_MAX;
+        if (escolhida < 0 || prazo < menor_prazo || (prazo == menor_prazo && frente.chegada < menor_chegada))
+        {
+            escolhida = i;
+            menor_prazo = prazo;
+            menor_chegada = frente.chegada;
+        }
+    }
+    return escolhida;
+}
+
+
+int sala_chama(sala_t *sala, cliente_t *cliente)
+{
+    if (sala->num_classes == 1)
+        return fila_desenfileira(&sala->filas[0], cliente);
+
+    int classe = escolhe_classe(sala);
+    if (classe < 0 || !fila_desenfileira(&sala->filas[classe], cliente))
+    {
+        //outro barbeiro levou o escolhido (ou e prioridade estrita): o primeiro que houver, da classe mais urgente
+        for (classe = 0; classe < sala->num_classes; classe++)
+        {
+            if (fila_desenfileira(&sala->filas[classe], cliente))
+                break;
+        }
+        if (classe == sala->num_classes)
+            return 0;
+    }
+    __atomic_sub_fetch(&sala->ocupadas, 1, __ATOMIC_RELAXED);
+
+    if (sala->escalonamento == ESCALONAMENTO_WFQ)
+    {
+        uint64_t passo = (uint64_t) (PASSE_BASE / sala->classes[classe].peso) + 1;
+        uint64_t passe = __atomic_fetch_add(&sala->passes[classe], passo, __ATOMIC_RELAXED);
+        __atomic_store_n(&sala->passe_atual, passe, __ATOMIC_RELAXED);
+    }
+    return 1;
+}
+
+
+int sala_tamanho(const sala_t *sala)
+{
+    if (sala->num_classes == 1)
+        return (int) fila_tamanho(&sala->filas[0]);
+    return __atomic_load_n(&sala->ocupadas, __ATOMIC_RELAXED);
+}
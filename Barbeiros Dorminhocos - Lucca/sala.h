@@ -0,0 +1,89 @@
+/*
+  Sala de espera com classes de clientes.
+  Cada classe tem a sua fila sem locks (fila.h) e todas dividem as mesmas cadeiras;
+  quando um barbeiro chama o proximo cliente o escalonamento escolhe de qual fila tirar:
+    fifo         o que chegou primeiro, de qualquer classe
+    prioridade   prioridade estrita: a classe 0 antes da 1, a 1 antes da 2...
+    wfq          weighted fair queuing: cada classe recebe atendimentos na proporcao do seu
+                 peso enquanto tiver clientes esperando (por passos, como o stride scheduling)
+    edf          earliest deadline first: o menor prazo; clientes sem prazo vem depois, por ordem de chegada
+  Dentro de uma classe o prazo e a chegada mais um valor fixo, entao a frente de cada fila
+  ja e o menor prazo da classe e basta comparar as frentes.
+  Com varios barbeiros a escolha e feita sem lock sobre uma visao que pode estar um pouco
+  desatualizada; com uma thread so (tempo virtual) ela e exata.
+ */
+
+#ifndef SALA_H
+#define SALA_H
+
+#include <stdint.h>
+
+#include "fila.h"
+#include "aleatorio.h"
+
+#define MAX_CLASSES 8
+
+typedef enum
+{
+    ESCALONAMENTO_FIFO = 0,
+    ESCALONAMENTO_PRIORIDADE = 1,
+    ESCALONAMENTO_WFQ = 2,
+    ESCALONAMENTO_EDF = 3
+} escalonamento_t;
+
+#define NUM_ESCALONAMENTOS 4
+
+typedef struct
+{
+    double fracao; //parte das chegadas
+    double peso; //parte dos atendimentos no wfq
+    uint64_t prazo; //quanto o cliente aceita esperar, em ns; 0 = sem prazo
+} classe_t;
+
+typedef struct
+{
+    fila_t filas[MAX_CLASSES]; //uma por classe
+    classe_t classes[MAX_CLASSES];
+    int num_classes;
+    escalonamento_t escalonamento;
+    int cadeiras;
+
+    //com uma classe so a propria fila conta as cadeiras; com varias elas sao reservadas aqui
+    int ocupadas __attribute__((aligned(TAMANHO_LINHA_CACHE)));
+
+    //wfq: passe de cada classe e o passe da ultima atendida, que as classes que voltam a ter clientes alcancam
+    uint64_t passes[MAX_CLASSES] __attribute__((aligned(TAMANHO_LINHA_CACHE)));
+    uint64_t passe_atual;
+} sala_t;
+
+//"fifo", "prioridade", "wfq" ou "edf"; -1 se o nome nao existe
+int escalonamento_por_nome(const char *nome);
+
+const char *escalonamento_nome(escalonamento_t escalonamento);
+
+//le "fracao[:peso[:prazo_us]],..." com ate MAX_CLASSES classes, a primeira a mais urgente.
+//as fracoes sao normalizadas para somar 1. retorna o numero de classes ou -1 se o texto nao e valido
+int classes_le(classe_t *classes, const char *texto);
+
+//sorteia a classe de um cliente que chega, pelas fracoes; com uma classe nao usa o gerador
+int classe_sorteia(const classe_t *classes, int num_classes, aleatorio_t *gerador);
+
+//prazo de um cliente da classe que chegou em chegada (ns); 0 se a classe nao tem prazo
+uint64_t classe_prazo(const classe_t *classe, uint64_t chegada);
+
+//retorna 0 ou -1 se faltar memoria
+int sala_inicia(sala_t *sala, int cadeiras, const classe_t *classes, int num_classes, escalonamento_t escalonamento);
+
+void sala_libera(sala_t *sala);
+
+//senta o cliente na fila da sua classe e preenche o prazo a partir da chegada.
+//retorna 1 se ele sentou, 0 se todas as cadeiras estao ocupadas
+int sala_senta(sala_t *sala, cliente_t cliente);
+
+//retorna 1 e preenche cliente com o proximo a ser atendido, ou 0 se nao ha cliente pronto
+int sala_chama(sala_t *sala, cliente_t *cliente);
+
+//numero aproximado de clientes sentados
+int sala_tamanho(const sala_t *sala);
+
+#endif
@@ -0,0 +1,317 @@
+#include "simulacao.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EVENTO_CHEGADA 0
+#define EVENTO_SAIDA 1
+
+typedef struct
+{
+    double tempo;
+    long sequencia; //desempate entre eventos no mesmo instante, na ordem em que foram agendados
+    int tipo;
+    int barbeiro;
+    long cliente;
+    double chegada;
+} evento_t;
+
+//fila de prioridade de eventos: heap binario ordenado por (tempo, sequencia)
+typedef struct
+{
+    evento_t *eventos;
+    int tamanho;
+    long proxima_sequencia;
+} agenda_t;
+
+static int antes(const evento_t *a, const evento_t *b)
+{
+    return a->tempo < b->tempo || (a->tempo == b->tempo && a->sequencia < b->sequencia);
+}
+
+
+static void agenda_insere(agenda_t *agenda, evento_t evento)
+{
+    evento.sequencia = agenda->proxima_sequencia++;
+
+    int i = agenda->tamanho++;
+    while (i > 0)
+    {
+        int pai = (i - 1) / 2;
+        if (!antes(&evento, &agenda->eventos[pai]))
+            break;
+        agenda->eventos[i] = agenda->eventos[pai];
+        i = pai;
+    }
+    agenda->eventos[i] = evento;
+}
+
+
+static evento_t agenda_retira(agenda_t *agenda)
+{
+    evento_t primeiro = agenda->eventos[0];
+    evento_t ultimo = agenda->eventos[--agenda->tamanho];
+
+    int i = 0;
+    while (1)
+    {
+        int filho = 2 * i + 1;
+        if (filho >= agenda->tamanho)
+            break;
+        if (filho + 1 < agenda->tamanho && antes(&agenda->eventos[filho + 1], &agenda->eventos[filho]))
+            filho++;
+        if (!antes(&agenda->eventos[filho], &ultimo))
+            break;
+        agenda->eventos[i] = agenda->eventos[filho];
+        i = filho;
+    }
+    agenda->eventos[i] = ultimo;
+    return primeiro;
+}
+
+
+//uma barbearia: as cadeiras sao uma sala de espera, como na versao com threads
+typedef struct
+{
+    sala_t sala;
+    int *barbeiros_livres; //pilha de barbeiros dormindo
+    int num_livres;
+    int clientes; //sentados mais os que estao cortando, o tamanho que o roteador compara
+} loja_t;
+
+static const char *nomes_roteamento[NUM_ROTEAMENTOS] = {"aleatorio", "rodizio", "jsq", "p2c"};
+
+int roteamento_por_nome(const char *nome)
+{
+    for (int i = 0; i < NUM_ROTEAMENTOS; i++)
+    {
+        if (strcmp(nome, nomes_roteamento[i]) == 0)
+            return i;
+    }
+    return -1;
+}
+
+
+const char *roteamento_nome(roteamento_t roteamento)
+{
+    return nomes_roteamento[roteamento];
+}
+
+
+typedef struct
+{
+    roteamento_t politica;
+    int lojas;
+    int proxima; //rodizio, e desempate da mais curta
+    aleatorio_t aleatorio;
+    int *visto; //tamanhos como o roteador os conhece
+    double proxima_atualizacao;
+} roteador_t;
+
+//tamanho da loja i como o roteador o conhece
+static int tamanho_visto(const roteador_t *roteador, const config_simulacao_t *config, const loja_t *lojas, int i)
+{
+    return config->atualizacao_roteamento > 0 ? roteador->visto[i] : lojas[i].clientes;
+}
+
+
+static int escolhe_loja(roteador_t *roteador, const config_simulacao_t *config, const loja_t *lojas, double relogio)
+{
+    int n = roteador->lojas;
+    if (n == 1)
+        return 0;
+
+    if (roteador->politica == ROTEAMENTO_ALEATORIO)
+        return (int) (aleatorio_proximo(&roteador->aleatorio) % n);
+
+    int inicio = roteador->proxima;
+    if (++roteador->proxima == n)
+        roteador->proxima = 0;
+    if (roteador->politica == ROTEAMENTO_RODIZIO)
+        return inicio;
+
+    //o roteador so ve os tamanhos de verdade a cada atualizacao_roteamento segundos
+    if (config->atualizacao_roteamento > 0 && relogio >= roteador->proxima_atualizacao)
+    {
+        for (int i = 0; i < n; i++)
+            roteador->visto[i] = lojas[i].clientes;
+        roteador->proxima_atualizacao = relogio + config->atualizacao_roteamento;
+    }
+
+    if (roteador->politica == ROTEAMENTO_DUAS_ESCOLHAS)
+    {
+        int a = (int) (aleatorio_proximo(&roteador->aleatorio) % n);
+        int b = (int) (aleatorio_proximo(&roteador->aleatorio) % (n - 1));
+        if (b >= a)
+            b++; //duas lojas diferentes
+        return tamanho_visto(roteador, config, lojas, b) < tamanho_visto(roteador, config, lojas, a) ? b : a;
+    }
+
+    //mais curta; os empates sao quebrados em rodizio para nao mandar todos para a primeira
+    int escolhida = inicio;
+    for (int k = 1, i = inicio; k < n; k++)
+    {
+        if (++i == n)
+            i = 0;
+        if (tamanho_visto(roteador, config, lojas, i) < tamanho_visto(roteador, config, lojas, escolhida))
+            escolhida = i;
+    }
+    return escolhida;
+}
+
+
+int simula_barbearia(const config_simulacao_t *config, metricas_t *metricas, resultado_simulacao_t *resultado)
+{
+    aleatorio_t gerador_chegadas, gerador_cortes, gerador_classes;
+    distribuicao_t chegadas = config->chegadas, cortes = config->cortes;
+    agenda_t agenda = {0};
+    roteador_t roteador = {0};
+    int num_lojas = config->lojas > 0 ? config->lojas : 1;
+    int total_barbeiros = num_lojas * config->barbeiros;
+
+    //no maximo uma chegada pendente e uma saida por barbeiro
+    agenda.eventos = malloc((total_barbeiros + 1) * sizeof(evento_t));
+    loja_t *lojas = NULL;
+    int *barbeiros_livres = malloc(total_barbeiros * sizeof(int));
+    roteador.visto = calloc(num_lojas, sizeof(int));
+    if (posix_memalign((void **) &lojas, TAMANHO_LINHA_CACHE, num_lojas * sizeof(loja_t)) != 0)
+        lojas = NULL;
+
+    int iniciadas = 0;
+    if (agenda.eventos != NULL && lojas != NULL && barbeiros_livres != NULL && roteador.visto != NULL)
+    {
+        while (iniciadas < num_lojas && sala_inicia(&lojas[iniciadas].sala, config->cadeiras, config->classes,
+                                                    config->num_classes, config->escalonamento) == 0)
+            iniciadas++;
+    }
+    if (iniciadas < num_lojas)
+    {
+        while (iniciadas > 0)
+            sala_libera(&lojas[--iniciadas].sala);
+        free(agenda.eventos);
+        free(lojas);
+        free(barbeiros_livres);
+        free(roteador.visto);
+        return -1;
+    }
+
+    for (int l = 0; l < num_lojas; l++)
+    {
+        loja_t *loja = &lojas[l];
+        loja->clientes = 0;
+        loja->barbeiros_livres = barbeiros_livres + l * config->barbeiros;
+        loja->num_livres = config->barbeiros;
+        for (int i = 0; i < config->barbeiros; i++)
+            loja->barbeiros_livres[i] = l * config->barbeiros + config->barbeiros - 1 - i; //o primeiro barbeiro da loja e o primeiro chamado
+    }
+
+    *resultado = (resultado_simulacao_t) {0};
+    aleatorio_semeia(&gerador_chegadas, config->semente);
+    aleatorio_semeia(&gerador_cortes, ~config->semente);
+    aleatorio_semeia(&roteador.aleatorio, config->semente ^ 0x5bd1e995u);
+    aleatorio_semeia(&gerador_classes, config->semente ^ 0x2545f4914f6cdd1dULL);
+    roteador.politica = config->roteamento;
+    roteador.lojas = num_lojas;
+
+    long proximo_cliente = 0;
+    if (config->clientes > 0)
+    {
+        double instante = distribuicao_amostra(&chegadas, &gerador_chegadas);
+        evento_t chegada = {instante, 0, EVENTO_CHEGADA, -1, 0, instante};
+        agenda_insere(&agenda, chegada);
+    }
+
+    while (agenda.tamanho > 0)
+    {
+        evento_t evento = agenda_retira(&agenda);
+        double relogio = evento.tempo;
+        resultado->eventos++;
+
+        if (evento.tipo == EVENTO_CHEGADA)
+        {
+            proximo_cliente++;
+            if (proximo_cliente < config->clientes)
+            {
+                double instante = relogio + distribuicao_amostra(&chegadas, &gerador_chegadas);
+                evento_t chegada = {instante, 0, EVENTO_CHEGADA, -1, proximo_cliente, instante};
+                agenda_insere(&agenda, chegada);
+            }
+
+            cliente_t cliente = {0};
+            cliente.id = evento.cliente;
+            cliente.classe = classe_sorteia(config->classes, config->num_classes, &gerador_classes);
+            cliente.chegada = (uint64_t) (relogio * 1e9);
+
+            loja_t *loja = &lojas[escolhe_loja(&roteador, config, lojas, relogio)];
+            metricas->fila_vista[sala_tamanho(&loja->sala)]++;
+
+            if (loja->num_livres > 0)
+            {
+                //um barbeiro dormindo acorda e atende na hora
+                int barbeiro = loja->barbeiros_livres[--loja->num_livres];
+                loja->clientes++;
+                if (config->imprime_eventos)
+                    printf("[%.6f] Barbeiro %d está cortando o cabelo do cliente %ld.\n", relogio, barbeiro, evento.cliente);
+
+                metricas_registra_espera(metricas, cliente.classe, 0, config->classes[cliente.classe].prazo);
+                double corte = distribuicao_amostra(&cortes, &gerador_cortes);
+                metricas->ocupado[barbeiro] += corte;
+                evento_t saida = {relogio + corte, 0, EVENTO_SAIDA, barbeiro, evento.cliente, relogio};
+                agenda_insere(&agenda, saida);
+            }
+            else if (sala_senta(&loja->sala, cliente))
+            {
+                loja->clientes++;
+                if (config->imprime_eventos)
+                    printf("[%.6f] Cliente %ld entrou na barbearia %ld e se sentou em uma cadeira.\n", relogio,
+                           evento.cliente, (long) (loja - lojas));
+            }
+            else
+            {
+                //se as cadeiras da fila de espera estiverem ocupadas o cliente vai embora
+                metricas_registra_desistente(metricas, cliente.classe);
+                if (config->imprime_eventos)
+                    printf("[%.6f] O cliente %ld não conseguiu se sentar na barbearia %ld e foi embora.\n", relogio,
+                           evento.cliente, (long) (loja - lojas));
+            }
+        }
+        else
+        {
+            loja_t *loja = &lojas[evento.barbeiro / config->barbeiros];
+            loja->clientes--;
+            metricas->atendidos++;
+            histograma_registra(&metricas->permanencia, (uint64_t) ((relogio - evento.chegada) * 1e9));
+            resultado->tempo_virtual = relogio;
+
+            cliente_t proximo;
+            if (sala_chama(&loja->sala, &proximo))
+            {
+                metricas_registra_espera(metricas, proximo.classe, (uint64_t) (relogio * 1e9) - proximo.chegada,
+                                         proximo.prazo > 0 ? proximo.prazo - proximo.chegada : 0);
+                if (config->imprime_eventos)
+                    printf("[%.6f] Barbeiro %d está cortando o cabelo do cliente %ld.\n", relogio, evento.barbeiro, proximo.id);
+
+                double corte = distribuicao_amostra(&cortes, &gerador_cortes);
+                metricas->ocupado[evento.barbeiro] += corte;
+                evento_t saida = {relogio + corte, 0, EVENTO_SAIDA, evento.barbeiro, proximo.id, proximo.chegada / 1e9};
+                agenda_insere(&agenda, saida);
+            }
+            else
+            {
+                //se nao existe (mais) nenhum cliente para ser atendido o barbeiro dorme
+                loja->barbeiros_livres[loja->num_livres++] = evento.barbeiro;
+                if (config->imprime_eventos)
+                    printf("[%.6f] Barbeiro %d está dormindo.\n", relogio, evento.barbeiro);
+            }
+        }
+    }
+
+    for (int l = 0; l < num_lojas; l++)
+        sala_libera(&lojas[l].sala);
+    free(agenda.eventos);
+    free(lojas);
+    free(barbeiros_livres);
+    free(roteador.visto);
+    return 0;
+}
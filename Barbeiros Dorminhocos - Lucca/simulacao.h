@@ -0,0 +1,71 @@
+/*
+  Barbearia em tempo virtual (simulacao de eventos discretos).
+  As mesmas regras da versao com threads - cadeiras de espera, barbeiros que dormem
+  quando nao ha clientes e clientes que vao embora quando as cadeiras estao ocupadas -
+  mas sem dormir de verdade: um relogio virtual salta de evento em evento, tirados
+  de uma fila de prioridade. Uma thread so processa milhoes de clientes por segundo
+  e a mesma semente reproduz exatamente a mesma execucao. Chegadas e cortes usam
+  sequencias aleatorias separadas, entao mudar um nao altera o sorteio do outro.
+
+  Com varias barbearias (lojas), cada uma tem as suas cadeiras e barbeiros e um
+  roteador na porta escolhe para qual o cliente vai; se ela estiver cheia o cliente
+  desiste, sem tentar outra. As politicas que olham o tamanho das filas podem ver
+  uma copia atualizada so de tempos em tempos, como um balanceador real.
+
+  As cadeiras de cada loja sao uma sala de espera (sala.h), com as classes de cliente e o
+  escalonamento escolhidos; a classe de cada chegada vem de mais uma sequencia aleatoria.
+ */
+
+#ifndef SIMULACAO_H
+#define SIMULACAO_H
+
+#include <stdint.h>
+
+#include "metricas.h"
+#include "distribuicao.h"
+#include "sala.h"
+
+typedef enum
+{
+    ROTEAMENTO_ALEATORIO = 0,
+    ROTEAMENTO_RODIZIO = 1,
+    ROTEAMENTO_MAIS_CURTA = 2, //join-shortest-queue: a loja com menos clientes
+    ROTEAMENTO_DUAS_ESCOLHAS = 3 //power of two choices: a menor de duas lojas sorteadas
+} roteamento_t;
+
+#define NUM_ROTEAMENTOS 4
+
+typedef struct
+{
+    int lojas;
+    roteamento_t roteamento;
+    double atualizacao_roteamento; //de quanto em quanto tempo o roteador ve os tamanhos; 0 = sempre exatos
+    int barbeiros; //por loja
+    int cadeiras; //por loja
+    const classe_t *classes;
+    int num_classes;
+    escalonamento_t escalonamento;
+    distribuicao_t chegadas; //intervalo entre chegadas, em segundos
+    distribuicao_t cortes; //tempo de corte, em segundos
+    long clientes;
+    uint64_t semente;
+    int imprime_eventos;
+} config_simulacao_t;
+
+typedef struct
+{
+    long eventos;
+    double tempo_virtual; //instante da ultima saida
+} resultado_simulacao_t;
+
+//"aleatorio", "rodizio", "jsq" ou "p2c"; -1 se o nome nao existe
+int roteamento_por_nome(const char *nome);
+
+const char *roteamento_nome(roteamento_t roteamento);
+
+//metricas ja deve estar iniciada com metricas_inicia para config->lojas * config->barbeiros barbeiros
+//(o barbeiro b da loja l e o l * barbeiros + b), config->cadeiras cadeiras e config->num_classes classes;
+//os tempos virtuais sao registrados nela em ns. retorna 0 ou -1 se faltar memoria
+int simula_barbearia(const config_simulacao_t *config, metricas_t *metricas, resultado_simulacao_t *resultado);
+
+#endif
@@ -6,7 +6,6 @@ use std::env;
 const TAMANHO_PAGINA: usize = 256;
 const NUM_PAGINAS: usize = 256;
 const NUM_FRAMES: usize = 128; // Originalmente 256 (para obter o resultado de correct.txt)
-const TAMANHO_MEMORIA: usize = TAMANHO_PAGINA * NUM_FRAMES;
 const TLB_ENTRADAS: usize = 16;
 
 const CAMINHO_BACKING_STORE: &str = "BACKING_STORE.bin";
@@ -14,7 +13,7 @@ const CAMINHO_BACKING_STORE: &str = "BACKING_STORE.bin";
 // Estrutura que representa uma memória
 struct Memoria
 {
-    dados: [u8; TAMANHO_MEMORIA],
+    dados: Vec<u8>,
     tabela_paginas: TabelaPaginas,
     tlb: VecDeque<Entrada>,
 }
@@ -31,6 +30,7 @@ struct TabelaPaginas
 {
     num_frames: [Option<usize>; NUM_PAGINAS],
     fila_substituicao: VecDeque<Entrada>,
+    max_frames: usize,
 }
 
 // Estrutura que representa o resultado de uma consulta na memória
@@ -44,13 +44,13 @@ struct ResultadoConsulta
 
 impl Memoria
 {
-    // Inicializa uma memória
-    pub fn nova() -> Memoria
+    // Inicializa uma memória com `max_frames` frames
+    pub fn nova(max_frames: usize) -> Memoria
     {
         Memoria
         {
-            dados: [0; TAMANHO_MEMORIA],
-            tabela_paginas: TabelaPaginas::nova(),
+            dados: vec![0; TAMANHO_PAGINA * max_frames],
+            tabela_paginas: TabelaPaginas::nova(max_frames),
             tlb: VecDeque::with_capacity(TLB_ENTRADAS),
         }
     }
@@ -138,7 +138,14 @@ impl Memoria
         else
         {
             // Page miss
-            let num_frame = self.tabela_paginas.obter_proximo_num_frame(num_pagina);
+            let (num_frame, pagina_substituida) = self.tabela_paginas.obter_proximo_num_frame(num_pagina);
+
+            // A página retirada da memória não pode continuar na TLB
+            if let Some(pagina_substituida) = pagina_substituida
+            {
+                self.tlb.retain(|entrada| entrada.num_pagina != pagina_substituida);
+            }
+
             self.atualizar_tlb(num_pagina, num_frame);
             self.ler_do_arquivo(num_pagina, num_frame, bck_store);
 
@@ -158,34 +165,38 @@ impl Memoria
 impl TabelaPaginas
 {
     // Inicializa uma tabela de páginas
-    pub fn nova() -> TabelaPaginas
+    pub fn nova(max_frames: usize) -> TabelaPaginas
     {
         TabelaPaginas
         {
             num_frames: [None; NUM_PAGINAS],
-            fila_substituicao: VecDeque::with_capacity(NUM_FRAMES),
+            fila_substituicao: VecDeque::with_capacity(max_frames),
+            max_frames,
         }
     }
 
-    // Obtém o número do frame correspondente à página `num_pagina`
-    pub fn obter_proximo_num_frame(&mut self, num_pagina: usize) -> usize
+    /*
+     Obtém o número do frame correspondente à página `num_pagina`, junto com a
+     página que foi retirada da memória para liberá-lo, se houver
+    */
+    pub fn obter_proximo_num_frame(&mut self, num_pagina: usize) -> (usize, Option<usize>)
     {
-        let num_frame = if self.fila_substituicao.len() == NUM_FRAMES
+        let (num_frame, pagina_substituida) = if self.fila_substituicao.len() == self.max_frames
         {
             // Memória está cheia, remover página mais antiga e usar o seu frame
             let pagina_substituida = self.fila_substituicao.pop_front().unwrap();
             self.num_frames[pagina_substituida.num_pagina] = None;
-            pagina_substituida.num_frame
+            (pagina_substituida.num_frame, Some(pagina_substituida.num_pagina))
         }
         else
         {
-            self.fila_substituicao.len() * TAMANHO_PAGINA
+            (self.fila_substituicao.len() * TAMANHO_PAGINA, None)
         };
 
         self.fila_substituicao.push_back(Entrada { num_pagina, num_frame: num_frame });
         self.num_frames[num_pagina] = Some(num_frame);
 
-        num_frame
+        (num_frame, pagina_substituida)
     }
 }
 
@@ -197,7 +208,15 @@ fn main() -> std::io::Result<()>
     let arquivo = File::open(caminho)?;
     let mut buf_reader = BufReader::new(arquivo);
 
-    let mut memoria = Memoria::nova();
+    // Número de frames opcional, entre 1 e NUM_PAGINAS
+    let max_frames = match env::args().nth(2)
+    {
+        Some(frames) => frames.trim().parse().expect("Número de frames inválido"),
+        None => NUM_FRAMES,
+    };
+    assert!(max_frames >= 1 && max_frames <= NUM_PAGINAS, "O número de frames deve estar entre 1 e {}", NUM_PAGINAS);
+
+    let mut memoria = Memoria::nova(max_frames);
 
     let mut page_faults = 0;
     let mut tlb_hits = 0;
@@ -0,0 +1,558 @@
+/*
+  Simulação por amostragem espacial (SHARDS) para traces muito grandes.
+  Só as páginas cujo hash fica abaixo de um limiar (taxa * 2^24) são simuladas,
+  e os tamanhos de cache são escalados pela mesma taxa. A memória e o tempo gastos
+  caem na proporção da taxa: o trace, em texto ou binário, é lido em blocos e
+  amostrado na hora, e as páginas ficam em tabelas hash em vez de uma tabela de
+  páginas plana, então o espaço de endereçamento pode ser qualquer um.
+
+  Para LRU a curva de faltas sai das distâncias de reuso da amostra (árvore de
+  Fenwick sobre o tempo do último acesso de cada página): com c quadros, uma
+  referência é falta se a distância for >= c * taxa. Para FIFO cada tamanho pedido
+  com -q é simulado na amostra com quadros * taxa quadros.
+
+  A taxa de faltas usa a correção SHARDS-adj: em cada grupo, a diferença entre as
+  referências esperadas (totalReferencias * taxa / GRUPOS) e as amostradas entra no
+  balde de distância 0, que é acerto para qualquer tamanho. Assim uma página muito
+  acessada que cai (ou não) na amostra não distorce o denominador. A taxa sem o
+  ajuste (faltas / amostradas) também é impressa. O intervalo de confiança vem de
+  GRUPOS subamostras independentes, separadas por outros bits do mesmo hash.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+#include "trace.h"
+
+#define BITS_HASH 24
+#define ESPACO_HASH (1 << BITS_HASH)
+#define GRUPOS 16
+#define MAX_TAMANHOS 32
+#define CAPACIDADE_INICIAL 1024
+#define BLOCO_TRACE 65536   // Endereços lidos do trace de cada vez.
+
+//==================== Structs ====================
+
+typedef struct
+{
+    uint32_t pagina;
+    uint32_t ocupada;
+    long valor;          // Tempo do último acesso (LRU) ou 1 se residente (FIFO).
+} entradaHash_t;
+
+typedef struct
+{
+    entradaHash_t *entradas;
+    long capacidade;     // Sempre potência de 2.
+    long usadas;
+} tabelaHash_t;
+
+typedef struct
+{
+    long quadros;        // Tamanho pedido, em quadros do trace completo.
+    long quadrosAmostra; // quadros * taxa, no mínimo 1.
+    uint32_t *fila;
+    long proximo;
+    long ocupados;
+    tabelaHash_t residentes;
+    long faltas[GRUPOS];
+} simulacaoFIFO_t;
+
+//==================== Variáveis Globais ====================
+
+uint64_t semente = 0;
+double taxa = 0.01;
+uint64_t limiar;
+
+tabelaHash_t ultimoAcesso;
+long *fenwick;                   // Marca 1 no tempo do último acesso de cada página.
+long capacidadeTempo = 0;
+long tempoAtual = 0;
+
+long *histograma;                // histograma[distancia * GRUPOS + grupo]
+long capacidadeHistograma = 0;
+long frias[GRUPOS];              // Primeiro acesso de cada página da amostra.
+long referenciasGrupo[GRUPOS];
+
+simulacaoFIFO_t simulacoes[MAX_TAMANHOS];
+int numSimulacoes = 0;
+
+long totalReferencias = 0;
+long referenciasAmostradas = 0;
+long paginasAmostradas = 0;
+
+//==================== Hash ====================
+
+/* splitmix64: os bits altos decidem a amostragem e os baixos o grupo. */
+uint64_t hashPagina(uint32_t pagina)
+{
+    uint64_t x = pagina + semente + 0x9E3779B97F4A7C15ULL;
+
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+
+    return x ^ (x >> 31);
+}
+
+void tabelaInicializa(tabelaHash_t *tabela)
+{
+    tabela->capacidade = CAPACIDADE_INICIAL;
+    tabela->usadas = 0;
+    tabela->entradas = calloc(tabela->capacidade, sizeof(entradaHash_t));
+}
+
+void tabelaCresce(tabelaHash_t *tabela)
+{
+    entradaHash_t *antigas = tabela->entradas;
+    long capacidadeAntiga = tabela->capacidade;
+
+    tabela->capacidade *= 2;
+    tabela->entradas = calloc(tabela->capacidade, sizeof(entradaHash_t));
+
+    for (long i = 0; i < capacidadeAntiga; i++)
+    {
+        if (antigas[i].ocupada)
+        {
+            long j = (long) (hashPagina(antigas[i].pagina) & (tabela->capacidade - 1));
+            while (tabela->entradas[j].ocupada)
+            {
+                j = (j + 1) & (tabela->capacidade - 1);
+            }
+            tabela->entradas[j] = antigas[i];
+        }
+    }
+    free(antigas);
+}
+
+/* Busca a página. Se criar, insere com valor 0 quando não existe; *nova indica a inserção. */
+entradaHash_t *tabelaBusca(tabelaHash_t *tabela, uint32_t pagina, uint64_t hash, int criar, int *nova)
+{
+    if (criar && 2 * (tabela->usadas + 1) > tabela->capacidade)
+    {
+        tabelaCresce(tabela);
+    }
+
+    long j = (long) (hash & (tabela->capacidade - 1));
+    while (tabela->entradas[j].ocupada)
+    {
+        if (tabela->entradas[j].pagina == pagina)
+        {
+            *nova = 0;
+            return &tabela->entradas[j];
+        }
+        j = (j + 1) & (tabela->capacidade - 1);
+    }
+
+    if (!criar)
+    {
+        return NULL;
+    }
+
+    tabela->entradas[j].ocupada = 1;
+    tabela->entradas[j].pagina = pagina;
+    tabela->entradas[j].valor = 0;
+    tabela->usadas++;
+    *nova = 1;
+
+    return &tabela->entradas[j];
+}
+
+void tabelaLibera(tabelaHash_t *tabela)
+{
+    free(tabela->entradas);
+}
+
+//==================== Distâncias de reuso ====================
+
+long fenwickSoma(long i)
+{
+    long soma = 0;
+    for (; i > 0; i -= i & -i)
+    {
+        soma += fenwick[i];
+    }
+
+    return soma;
+}
+
+void fenwickAdiciona(long i, long delta)
+{
+    for (; i <= capacidadeTempo; i += i & -i)
+    {
+        fenwick[i] += delta;
+    }
+}
+
+int comparaTempo(const void *a, const void *b)
+{
+    long ta = (*(entradaHash_t *const *) a)->valor;
+    long tb = (*(entradaHash_t *const *) b)->valor;
+
+    return (ta > tb) - (ta < tb);
+}
+
+/*
+ Renumera os tempos de 1 a paginasAmostradas mantendo a ordem, para que a árvore
+ de Fenwick tenha tamanho proporcional às páginas da amostra e não ao trace.
+ */
+void compactaTempos()
+{
+    entradaHash_t **ordem = malloc(sizeof(entradaHash_t *) * (paginasAmostradas + 1));
+    long n = 0;
+
+    for (long i = 0; i < ultimoAcesso.capacidade; i++)
+    {
+        if (ultimoAcesso.entradas[i].ocupada)
+        {
+            ordem[n++] = &ultimoAcesso.entradas[i];
+        }
+    }
+    qsort(ordem, n, sizeof(entradaHash_t *), comparaTempo);
+
+    if (2 * n + CAPACIDADE_INICIAL > capacidadeTempo)
+    {
+        capacidadeTempo = 2 * n + CAPACIDADE_INICIAL;
+        free(fenwick);
+        fenwick = malloc(sizeof(long) * (capacidadeTempo + 1));
+    }
+    memset(fenwick, 0, sizeof(long) * (capacidadeTempo + 1));
+
+    for (long i = 0; i < n; i++)
+    {
+        ordem[i]->valor = i + 1;
+        fenwickAdiciona(i + 1, 1);
+    }
+    tempoAtual = n;
+
+    free(ordem);
+}
+
+void registraDistancia(long distancia, int grupo)
+{
+    if (distancia >= capacidadeHistograma)
+    {
+        long nova = capacidadeHistograma == 0 ? CAPACIDADE_INICIAL : capacidadeHistograma;
+        while (nova <= distancia)
+        {
+            nova *= 2;
+        }
+        histograma = realloc(histograma, sizeof(long) * GRUPOS * nova);
+        memset(histograma + GRUPOS * capacidadeHistograma, 0,
+               sizeof(long) * GRUPOS * (nova - capacidadeHistograma));
+        capacidadeHistograma = nova;
+    }
+    histograma[distancia * GRUPOS + grupo]++;
+}
+
+/* Atualiza a pilha LRU da amostra com um acesso à página. */
+void acessaLRU(uint32_t pagina, uint64_t hash, int grupo)
+{
+    if (tempoAtual == capacidadeTempo)
+    {
+        compactaTempos();
+    }
+
+    int nova;
+    entradaHash_t *entrada = tabelaBusca(&ultimoAcesso, pagina, hash, 1, &nova);
+
+    if (nova)
+    {
+        frias[grupo]++;
+        paginasAmostradas++;
+    }
+    else
+    {
+        // Páginas distintas acessadas depois do último acesso a esta.
+        registraDistancia(fenwickSoma(tempoAtual) - fenwickSoma(entrada->valor), grupo);
+        fenwickAdiciona(entrada->valor, -1);
+    }
+
+    tempoAtual++;
+    fenwickAdiciona(tempoAtual, 1);
+    entrada->valor = tempoAtual;
+}
+
+//==================== FIFO ====================
+
+void inicializaFIFO(simulacaoFIFO_t *simulacao, long quadros)
+{
+    memset(simulacao, 0, sizeof(*simulacao));
+    simulacao->quadros = quadros;
+    simulacao->quadrosAmostra = llround(quadros * taxa) > 0 ? llround(quadros * taxa) : 1;
+    simulacao->fila = malloc(sizeof(uint32_t) * simulacao->quadrosAmostra);
+    tabelaInicializa(&simulacao->residentes);
+}
+
+void acessaFIFO(simulacaoFIFO_t *simulacao, uint32_t pagina, uint64_t hash, int grupo)
+{
+    int nova;
+    entradaHash_t *entrada = tabelaBusca(&simulacao->residentes, pagina, hash, 1, &nova);
+
+    if (entrada->valor)
+    {
+        return;
+    }
+
+    simulacao->faltas[grupo]++;
+
+    if (simulacao->ocupados == simulacao->quadrosAmostra)
+    {
+        uint32_t vitima = simulacao->fila[simulacao->proximo];
+        tabelaBusca(&simulacao->residentes, vitima, hashPagina(vitima), 0, &nova)->valor = 0;
+        simulacao->fila[simulacao->proximo] = pagina;
+        simulacao->proximo = (simulacao->proximo + 1) % simulacao->quadrosAmostra;
+    }
+    else
+    {
+        simulacao->fila[simulacao->ocupados++] = pagina;
+    }
+    entrada->valor = 1;
+}
+
+//==================== Estimativas ====================
+
+/* Faltas LRU da amostra no grupo com quadros quadros do trace completo. */
+long faltasLRU(long quadros, int grupo)
+{
+    long faltas = frias[grupo];
+    long inicio = (long) ceil(quadros * taxa);
+
+    for (long d = inicio; d < capacidadeHistograma; d++)
+    {
+        faltas += histograma[d * GRUPOS + grupo];
+    }
+
+    return faltas;
+}
+
+/*
+ Estima a taxa de faltas do trace completo a partir das faltas de cada grupo (SHARDS-adj).
+ *margem recebe a meia largura do intervalo de 95%, ou 0 quando a amostra é o trace inteiro.
+ */
+double estimaTaxa(const long faltas[GRUPOS], double *margem)
+{
+    // Cada grupo é uma amostra independente com taxa / GRUPOS.
+    double esperadas = totalReferencias * taxa / GRUPOS;
+    double taxas[GRUPOS];
+    double totalFaltas = 0;
+    double totalReferenciasAjustadas = 0;
+
+    for (int g = 0; g < GRUPOS; g++)
+    {
+        // O ajuste vai para o balde de distância 0: muda o total de referências, não as faltas.
+        double ajuste = esperadas - referenciasGrupo[g];
+        double referencias = referenciasGrupo[g] + ajuste;
+
+        taxas[g] = referencias > 0 ? faltas[g] / referencias : 0;
+        totalFaltas += faltas[g];
+        totalReferenciasAjustadas += referencias;
+    }
+
+    double estimativa = totalReferenciasAjustadas > 0 ? totalFaltas / totalReferenciasAjustadas : 0;
+
+    double variancia = 0;
+    for (int g = 0; g < GRUPOS; g++)
+    {
+        variancia += (taxas[g] - estimativa) * (taxas[g] - estimativa);
+    }
+    variancia /= (double) GRUPOS * (GRUPOS - 1);
+
+    *margem = taxa >= 1.0 ? 0 : 1.96 * sqrt(variancia);
+
+    return estimativa;
+}
+
+void imprimeEstimativa(const char *politica, long quadros, const long faltas[GRUPOS])
+{
+    double margem;
+    double estimativa = estimaTaxa(faltas, &margem);
+
+    long totalFaltas = 0;
+    for (int g = 0; g < GRUPOS; g++)
+    {
+        totalFaltas += faltas[g];
+    }
+
+    printf("  %-5s %8ld quadros  taxa de faltas %.4f ± %.4f  (%.0f faltas, sem ajuste %.4f)\n", politica, quadros,
+           estimativa, margem, estimativa * totalReferencias,
+           referenciasAmostradas > 0 ? (double) totalFaltas / referenciasAmostradas : 0.0);
+}
+
+double agora()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// ==================== MAIN ====================
+int main(int argc, const char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Uso ./amostragem trace [-d bitsDeslocamento] [-r taxa] [-s semente] [-q quadros]...\n");
+        exit(1);
+    }
+
+    int bitsDeslocamento = 10;
+    long tamanhos[MAX_TAMANHOS];
+    int numTamanhos = 0;
+
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "-d") == 0)
+        {
+            bitsDeslocamento = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "-r") == 0)
+        {
+            taxa = atof(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "-s") == 0)
+        {
+            semente = strtoull(argv[i + 1], NULL, 10);
+        }
+        else if (strcmp(argv[i], "-q") == 0 && numTamanhos < MAX_TAMANHOS)
+        {
+            tamanhos[numTamanhos++] = atol(argv[i + 1]);
+        }
+    }
+
+    if (taxa <= 0 || taxa > 1 || bitsDeslocamento < 0 || bitsDeslocamento > 31)
+    {
+        fprintf(stderr, "Taxa deve estar em (0, 1] e bitsDeslocamento em [0, 31]\n");
+        exit(1);
+    }
+    limiar = (uint64_t) (taxa * ESPACO_HASH);
+
+    // O trace é lido em blocos e amostrado na hora, então nunca fica inteiro na memória.
+    leitorTrace_t *leitor = traceAbre(argv[1]);
+    if (leitor == NULL)
+    {
+        fprintf(stderr, "Erro ao abrir o trace %s\n", argv[1]);
+        exit(1);
+    }
+
+    tabelaInicializa(&ultimoAcesso);
+    compactaTempos();
+    for (int i = 0; i < numTamanhos; i++)
+    {
+        inicializaFIFO(&simulacoes[numSimulacoes++], tamanhos[i]);
+    }
+
+    // O tempo medido inclui ler e converter o trace, que acontece junto com a amostragem.
+    double inicio = agora();
+
+    static int enderecos[BLOCO_TRACE];
+    long quantidade;
+
+    while ((quantidade = traceLe(leitor, enderecos, BLOCO_TRACE)) > 0)
+    {
+        for (long i = 0; i < quantidade; i++)
+        {
+            // As operações unmap/madvise do trace não são referências; escritas são.
+            if (traceEhOperacao(enderecos[i]))
+            {
+                continue;
+            }
+            totalReferencias++;
+
+            uint32_t pagina = (uint32_t) traceEndereco(enderecos[i]) >> bitsDeslocamento;
+            uint64_t hash = hashPagina(pagina);
+
+            if ((hash >> (64 - BITS_HASH)) >= limiar)
+            {
+                continue;
+            }
+
+            int grupo = (int) ((hash >> 32) & (GRUPOS - 1));
+            referenciasAmostradas++;
+            referenciasGrupo[grupo]++;
+
+            acessaLRU(pagina, hash, grupo);
+            for (int s = 0; s < numSimulacoes; s++)
+            {
+                acessaFIFO(&simulacoes[s], pagina, hash, grupo);
+            }
+        }
+    }
+    traceFecha(leitor);
+    if (quantidade < 0)
+    {
+        fprintf(stderr, "Erro ao ler o trace %s\n", argv[1]);
+        exit(1);
+    }
+
+    double segundos = agora() - inicio;
+
+    long bytes = ultimoAcesso.capacidade * (long) sizeof(entradaHash_t) + (capacidadeTempo + 1) * (long) sizeof(long) +
+                 capacidadeHistograma * GRUPOS * (long) sizeof(long);
+    for (int s = 0; s < numSimulacoes; s++)
+    {
+        bytes += simulacoes[s].residentes.capacidade * (long) sizeof(entradaHash_t) +
+                 simulacoes[s].quadrosAmostra * (long) sizeof(uint32_t);
+    }
+
+    printf("==========================================\n");
+    printf("Taxa de amostragem = %g\n", taxa);
+    printf("Referências = %ld (amostradas %ld, esperado %.0f)\n", totalReferencias, referenciasAmostradas,
+           totalReferencias * taxa);
+    printf("Páginas distintas amostradas = %ld (estimativa total %.0f)\n", paginasAmostradas, paginasAmostradas / taxa);
+    printf("Memória da simulação = %.1f KiB\n", bytes / 1024.0);
+    printf("Tempo = %.3f s (%.2f Mref/s)\n", segundos, segundos > 0 ? totalReferencias / segundos / 1e6 : 0.0);
+
+    if (totalReferencias == 0)
+    {
+        return 0;
+    }
+
+    long faltas[GRUPOS];
+
+    if (numSimulacoes > 0)
+    {
+        printf("------------------------------------------\n");
+        for (int s = 0; s < numSimulacoes; s++)
+        {
+            for (int g = 0; g < GRUPOS; g++)
+            {
+                faltas[g] = faltasLRU(simulacoes[s].quadros, g);
+            }
+            imprimeEstimativa("LRU", simulacoes[s].quadros, faltas);
+            imprimeEstimativa("FIFO", simulacoes[s].quadros, simulacoes[s].faltas);
+        }
+    }
+
+    // Curva de faltas LRU em potências de 2 até cobrir todas as páginas estimadas.
+    printf("------------------------------------------\n");
+    printf("Curva de faltas (LRU):\n");
+    for (long quadros = 1; ; quadros *= 2)
+    {
+        for (int g = 0; g < GRUPOS; g++)
+        {
+            faltas[g] = faltasLRU(quadros, g);
+        }
+        imprimeEstimativa("LRU", quadros, faltas);
+
+        if (quadros * taxa >= paginasAmostradas)
+        {
+            break;
+        }
+    }
+    printf("==========================================\n");
+
+    for (int s = 0; s < numSimulacoes; s++)
+    {
+        free(simulacoes[s].fila);
+        tabelaLibera(&simulacoes[s].residentes);
+    }
+    tabelaLibera(&ultimoAcesso);
+    free(fenwick);
+    free(histograma);
+
+    return 0;
+}
@@ -0,0 +1,356 @@
+/*
+  Verificação diferencial entre as implementações do gerenciador de memória.
+  Gera um BACKING_STORE e um trace, roda main.c, virtualManager.c, Rust.rs e a
+  biblioteca simulador com a mesma geometria (256 páginas de 256 bytes) e compara,
+  referência por referência, o endereço físico e o valor lido. Também mede as
+  traduções por segundo de cada uma (para os executáveis, inclui ler o trace e
+  imprimir o resultado).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "simulador.h"
+
+#define TAMANHO_PAGINA 256
+#define BITS_DESLOCAMENTO 8
+#define NUM_PAGINAS 256
+#define TAMANHO_BACKING (TAMANHO_PAGINA * NUM_PAGINAS)
+#define TAMANHO_COMANDO (3 * PATH_MAX)
+#define MAX_DIVERGENCIAS_IMPRESSAS 5
+
+//==================== Structs ====================
+
+typedef struct
+{
+    const char *nome;
+    int *fisicos;
+    int *valores;     // Byte lido, sempre entre 0 e 255.
+    long quantidade;
+    double segundos;
+} resultado_t;
+
+//==================== Variáveis Globais ====================
+
+char diretorio[] = "/tmp/comparadorXXXXXX";
+uint64_t estadoAleatorio;
+
+//==================== Funções ====================
+
+/* xorshift64*, para que a mesma semente gere sempre os mesmos arquivos. */
+uint64_t aleatorio()
+{
+    estadoAleatorio ^= estadoAleatorio >> 12;
+    estadoAleatorio ^= estadoAleatorio << 25;
+    estadoAleatorio ^= estadoAleatorio >> 27;
+
+    return estadoAleatorio * 0x2545F4914F6CDD1DULL;
+}
+
+double agora()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/* Caminho de um arquivo dentro do diretório temporário. */
+const char *caminho(const char *nome)
+{
+    static char buffer[PATH_MAX];
+    snprintf(buffer, sizeof(buffer), "%s/%s", diretorio, nome);
+
+    return buffer;
+}
+
+void geraBacking()
+{
+    FILE *arquivo = fopen(caminho("BACKING_STORE.bin"), "wb");
+
+    for (int i = 0; i < TAMANHO_BACKING; i++)
+    {
+        fputc((int) (aleatorio() & 0xFF), arquivo);
+    }
+    fclose(arquivo);
+}
+
+/*
+ Gera n endereços com localidade: a maior parte fica em um conjunto de páginas
+ "quentes" que muda aos poucos, o resto é espalhado por todo o espaço.
+ */
+int *geraTrace(long n)
+{
+    int *enderecos = malloc(sizeof(int) * n);
+    FILE *arquivo = fopen(caminho("trace.txt"), "w");
+    int base = 0;
+
+    for (long i = 0; i < n; i++)
+    {
+        uint64_t sorteio = aleatorio();
+        int pagina;
+
+        if (sorteio % 100 < 2)
+        {
+            base = (int) (aleatorio() % NUM_PAGINAS);
+        }
+
+        if (sorteio % 100 < 85)
+        {
+            pagina = (base + (int) (aleatorio() % 8)) % NUM_PAGINAS;
+        }
+        else
+        {
+            pagina = (int) (aleatorio() % NUM_PAGINAS);
+        }
+
+        enderecos[i] = pagina * TAMANHO_PAGINA + (int) (aleatorio() % TAMANHO_PAGINA);
+        fprintf(arquivo, "%d\n", enderecos[i]);
+    }
+    fclose(arquivo);
+
+    return enderecos;
+}
+
+/* Lê as linhas "... <virtual> ... <físico> Valor: <valor>" da saída de uma implementação. */
+long leSaida(const char *nomeArquivo, resultado_t *resultado, long n)
+{
+    FILE *arquivo = fopen(nomeArquivo, "r");
+    char linha[256];
+    long quantidade = 0;
+
+    if (arquivo == NULL)
+    {
+        return 0;
+    }
+
+    while (fgets(linha, sizeof(linha), arquivo) != NULL && quantidade < n)
+    {
+        char *valor = strstr(linha, "Valor:");
+        if (valor == NULL)
+        {
+            continue;
+        }
+
+        // O endereço físico é o último número antes de "Valor:".
+        char *p = valor;
+        while (p > linha && (p[-1] == ' ' || (p[-1] >= '0' && p[-1] <= '9')))
+        {
+            p--;
+        }
+
+        resultado->fisicos[quantidade] = atoi(p);
+        resultado->valores[quantidade] = atoi(valor + strlen("Valor:")) & 0xFF;
+        quantidade++;
+    }
+    fclose(arquivo);
+
+    return quantidade;
+}
+
+void alocaResultado(resultado_t *resultado, const char *nome, long n)
+{
+    resultado->nome = nome;
+    resultado->fisicos = calloc(n, sizeof(int));
+    resultado->valores = calloc(n, sizeof(int));
+    resultado->quantidade = 0;
+    resultado->segundos = 0;
+}
+
+/* Roda um executável pelo shell, dentro do diretório temporário, e lê a saída dele. */
+void executa(resultado_t *resultado, const char *comando, long n)
+{
+    char completo[TAMANHO_COMANDO];
+    snprintf(completo, sizeof(completo), "cd '%s' && %s > saida.txt", diretorio, comando);
+
+    double inicio = agora();
+    int status = system(completo);
+    resultado->segundos = agora() - inicio;
+
+    if (status != 0)
+    {
+        fprintf(stderr, "%s terminou com status %d\n", resultado->nome, status);
+    }
+
+    resultado->quantidade = leSaida(caminho("saida.txt"), resultado, n);
+}
+
+/* Roda a biblioteca no próprio processo, só a tradução em lote é medida. */
+void executaBiblioteca(resultado_t *resultado, const int *enderecos, long n, int quadros, politica_t politica)
+{
+    configSimulador_t config;
+    simuladorConfigPadrao(&config);
+    config.bitsDeslocamento = BITS_DESLOCAMENTO;
+    config.paginas = NUM_PAGINAS;
+    config.quadros = quadros;
+    config.politica = politica;
+    config.arquivoBacking = caminho("BACKING_STORE.bin");
+
+    simulador_t *sim = simuladorCria(&config);
+    if (sim == NULL)
+    {
+        fprintf(stderr, "Erro ao criar o simulador\n");
+        return;
+    }
+
+    unsigned char *valores = malloc(n);
+
+    double inicio = agora();
+    simuladorTraduzLote(sim, enderecos, (int) n, resultado->fisicos, valores);
+    resultado->segundos = agora() - inicio;
+
+    for (long i = 0; i < n; i++)
+    {
+        resultado->valores[i] = valores[i];
+    }
+    resultado->quantidade = n;
+
+    free(valores);
+    simuladorDestroi(sim);
+}
+
+/* Compara com a referência e imprime a linha da implementação. Retorna o número de divergências. */
+long compara(const resultado_t *referencia, const resultado_t *resultado, const int *enderecos, long n)
+{
+    long divergencias = 0;
+
+    for (long i = 0; i < n; i++)
+    {
+        if (i >= resultado->quantidade ||
+            resultado->fisicos[i] != referencia->fisicos[i] || resultado->valores[i] != referencia->valores[i])
+        {
+            if (divergencias < MAX_DIVERGENCIAS_IMPRESSAS)
+            {
+                printf("    #%ld virtual %d: %s = (%d, %d), %s = (%d, %d)\n", i, enderecos[i],
+                       referencia->nome, referencia->fisicos[i], referencia->valores[i],
+                       resultado->nome, resultado->fisicos[i], resultado->valores[i]);
+            }
+            divergencias++;
+        }
+    }
+
+    printf("  %-18s %10.2f Mtrad/s  %ld divergências\n", resultado->nome,
+           resultado->segundos > 0 ? resultado->quantidade / resultado->segundos / 1e6 : 0.0, divergencias);
+
+    return divergencias;
+}
+
+void liberaResultado(resultado_t *resultado)
+{
+    free(resultado->fisicos);
+    free(resultado->valores);
+}
+
+void removeArquivos()
+{
+    unlink(caminho("BACKING_STORE.bin"));
+    unlink(caminho("trace.txt"));
+    unlink(caminho("saida.txt"));
+    rmdir(diretorio);
+}
+
+// ==================== MAIN ====================
+int main(int argc, const char *argv[])
+{
+    if (argc < 4)
+    {
+        fprintf(stderr, "Uso ./comparador main virtualManager rust|- [-n referencias] [-q quadros] [-s semente]\n");
+        exit(1);
+    }
+
+    char binarioMain[PATH_MAX];
+    char binarioVirtualManager[PATH_MAX];
+    char binarioRust[PATH_MAX];
+    int usaRust = strcmp(argv[3], "-") != 0;
+
+    // Os executáveis rodam dentro do diretório temporário, então os caminhos precisam ser absolutos.
+    if (realpath(argv[1], binarioMain) == NULL || realpath(argv[2], binarioVirtualManager) == NULL ||
+        (usaRust && realpath(argv[3], binarioRust) == NULL))
+    {
+        fprintf(stderr, "Executável não encontrado\n");
+        exit(1);
+    }
+
+    long n = 200000;
+    int quadros = 64;
+    estadoAleatorio = 88172645463325252ULL;
+
+    for (int i = 4; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "-n") == 0)
+        {
+            n = atol(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "-q") == 0)
+        {
+            quadros = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "-s") == 0)
+        {
+            estadoAleatorio = strtoull(argv[i + 1], NULL, 10) | 1;
+        }
+    }
+
+    if (mkdtemp(diretorio) == NULL)
+    {
+        fprintf(stderr, "Erro ao criar o diretório temporário\n");
+        exit(1);
+    }
+
+    geraBacking();
+    int *enderecos = geraTrace(n);
+    long divergencias = 0;
+
+    // O Rust.rs só implementa FIFO. virtualManager.c lê a política da entrada padrão.
+    const char *politicas[] = {"fifo", "lru", "clock"};
+    const int opcoesVirtualManager[] = {0, 1, 3};
+    const politica_t politicasBiblioteca[] = {POLITICA_FIFO, POLITICA_LRU, POLITICA_RELOGIO};
+
+    for (int p = 0; p < 3; p++)
+    {
+        char comando[TAMANHO_COMANDO];
+        resultado_t resultados[4];
+        int numResultados = 0;
+
+        printf("Política %s, %d quadros de %d bytes, %ld referências\n", politicas[p], quadros, TAMANHO_PAGINA, n);
+
+        alocaResultado(&resultados[numResultados], "main.c", n);
+        snprintf(comando, sizeof(comando), "'%s' trace.txt BACKING_STORE.bin %d %s", binarioMain, quadros, politicas[p]);
+        executa(&resultados[numResultados++], comando, n);
+
+        alocaResultado(&resultados[numResultados], "virtualManager.c", n);
+        snprintf(comando, sizeof(comando), "echo %d | '%s' trace.txt BACKING_STORE.bin -g %d %d %d",
+                 opcoesVirtualManager[p], binarioVirtualManager, BITS_DESLOCAMENTO, NUM_PAGINAS, quadros);
+        executa(&resultados[numResultados++], comando, n);
+
+        if (usaRust && p == 0)
+        {
+            alocaResultado(&resultados[numResultados], "Rust.rs", n);
+            snprintf(comando, sizeof(comando), "'%s' trace.txt %d", binarioRust, quadros);
+            executa(&resultados[numResultados++], comando, n);
+        }
+
+        alocaResultado(&resultados[numResultados], "simulador (lote)", n);
+        executaBiblioteca(&resultados[numResultados++], enderecos, n, quadros, politicasBiblioteca[p]);
+
+        // main.c é a referência.
+        for (int i = 1; i < numResultados; i++)
+        {
+            divergencias += compara(&resultados[0], &resultados[i], enderecos, n);
+        }
+        for (int i = 0; i < numResultados; i++)
+        {
+            liberaResultado(&resultados[i]);
+        }
+    }
+
+    free(enderecos);
+    removeArquivos();
+
+    return divergencias == 0 ? 0 : 1;
+}
@@ -0,0 +1,27 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "trace.h"
+
+// ==================== MAIN ====================
+int main(int argc, const char *argv[])
+{
+    if (argc != 3 && argc != 4)
+    {
+        fprintf(stderr, "Uso ./conversorTrace entrada.txt saida.trc [threads]\n");
+        exit(1);
+    }
+
+    int numThreads = argc == 4 ? atoi(argv[3]) : traceThreadsPadrao();
+    long quantidade = traceConverteTexto(argv[1], argv[2], numThreads);
+
+    if (quantidade < 0)
+    {
+        fprintf(stderr, "Erro ao converter %s para %s\n", argv[1], argv[2]);
+        exit(1);
+    }
+
+    printf("%ld endereços convertidos com %d threads.\n", quantidade, numThreads);
+
+    return 0;
+}
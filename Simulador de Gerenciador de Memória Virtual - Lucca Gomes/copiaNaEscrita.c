@@ -0,0 +1,413 @@
+/*
+  Simulador de cópia na escrita (copy-on-write) para cargas com fork.
+  Vários espaços de endereçamento compartilham quadros com contagem de referências.
+  Um fork compartilha todas as páginas do pai com o filho; a primeira escrita em
+  uma página compartilhada aloca um quadro novo e copia a página.
+
+  Formato do trace (uma operação por linha, pid entre 0 e MAX_PROCESSOS - 1):
+    R pid endereco           leitura
+    W pid endereco [valor]   escrita
+    F pid filho              fork: filho recebe uma cópia do espaço de pid
+    M pid pagina objeto      mapeia a página do BACKING_STORE "objeto" como memória
+                             compartilhada (escritas não são copiadas)
+    X pid                    fim do processo, libera os quadros dele
+  Uma linha só com um número é uma leitura do processo 0, como em adresses.txt.
+ */
+
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TAMANHO_PAGINA 1024
+#define BITS_DESLOCAMENTO 10
+#define MASCARA_DESLOCAMENTO 1023
+#define PAGINAS 1024
+#define TAMANHO_MEMORIA_LOGICA (PAGINAS * TAMANHO_PAGINA)
+#define MAX_PROCESSOS 1024
+#define TAMANHO_BUFFER 64
+
+//==================== Structs ====================
+
+struct entradaPagina
+{
+    int quadro;          // -1 se a página não está mapeada.
+    char cow;            // Compartilhada até a próxima escrita.
+    char compartilhada;  // Memória compartilhada: escritas vão para o mesmo quadro.
+};
+
+typedef struct
+{
+    int vivo;
+    int residentes;      // Páginas mapeadas pelo processo.
+    struct entradaPagina *tabela;
+} processo_t;
+
+//==================== Variáveis Globais ====================
+
+processo_t processos[MAX_PROCESSOS];
+
+unsigned char *memoria;          // Cresce conforme a demanda de quadros.
+int *referenciasQuadro;          // Entradas de tabelas de páginas que apontam para cada quadro.
+int *quadrosLivres;              // Pilha de quadros liberados.
+int numQuadrosLivres = 0;
+int capacidadeQuadros = 0;
+int proximoQuadroNovo = 0;
+int quadrosEmUso = 0;
+
+int quadroDoObjeto[PAGINAS];     // Quadro de cada objeto compartilhado, ou -1.
+unsigned char *suporte;
+
+long totalReferencias = 0;
+long faltasPagina = 0;
+long faltasCOW = 0;
+long reusoCOW = 0;               // Escrita em página COW que já não era compartilhada.
+long bytesCopiados = 0;
+long forks = 0;
+long paginasResidentes = 0;      // Soma das páginas mapeadas de todos os processos vivos.
+long picoQuadros = 0;
+long picoResidentes = 0;
+long maiorEconomia = 0;          // Maior diferença entre páginas residentes e quadros em uso.
+
+//==================== Quadros ====================
+
+int alocaQuadro()
+{
+    int quadro;
+
+    if (numQuadrosLivres > 0)
+    {
+        quadro = quadrosLivres[--numQuadrosLivres];
+    }
+    else
+    {
+        if (proximoQuadroNovo == capacidadeQuadros)
+        {
+            capacidadeQuadros = capacidadeQuadros ? capacidadeQuadros * 2 : 256;
+            memoria = realloc(memoria, (size_t) capacidadeQuadros * TAMANHO_PAGINA);
+            referenciasQuadro = realloc(referenciasQuadro, sizeof(int) * capacidadeQuadros);
+            quadrosLivres = realloc(quadrosLivres, sizeof(int) * capacidadeQuadros);
+
+            if (memoria == NULL || referenciasQuadro == NULL || quadrosLivres == NULL)
+            {
+                fprintf(stderr, "Memória insuficiente para %d quadros\n", capacidadeQuadros);
+                exit(1);
+            }
+        }
+        quadro = proximoQuadroNovo++;
+    }
+
+    referenciasQuadro[quadro] = 1;
+    quadrosEmUso++;
+    if (quadrosEmUso > picoQuadros)
+    {
+        picoQuadros = quadrosEmUso;
+    }
+
+    return quadro;
+}
+
+void liberaReferencia(int quadro)
+{
+    if (--referenciasQuadro[quadro] == 0)
+    {
+        quadrosLivres[numQuadrosLivres++] = quadro;
+        quadrosEmUso--;
+    }
+}
+
+void carregaPagina(int quadro, int pagina)
+{
+    memcpy(memoria + (size_t) quadro * TAMANHO_PAGINA, suporte + (size_t) pagina * TAMANHO_PAGINA, TAMANHO_PAGINA);
+}
+
+//==================== Processos ====================
+
+void contaResidente(processo_t *processo, int delta)
+{
+    processo->residentes += delta;
+    paginasResidentes += delta;
+
+    if (paginasResidentes > picoResidentes)
+    {
+        picoResidentes = paginasResidentes;
+    }
+}
+
+processo_t *obtemProcesso(int pid)
+{
+    if (pid < 0 || pid >= MAX_PROCESSOS)
+    {
+        return NULL;
+    }
+
+    processo_t *processo = &processos[pid];
+
+    // O primeiro uso de um pid cria o processo com o espaço vazio.
+    if (!processo->vivo)
+    {
+        processo->tabela = malloc(sizeof(struct entradaPagina) * PAGINAS);
+        for (int i = 0; i < PAGINAS; i++)
+        {
+            processo->tabela[i].quadro = -1;
+            processo->tabela[i].cow = 0;
+            processo->tabela[i].compartilhada = 0;
+        }
+        processo->residentes = 0;
+        processo->vivo = 1;
+    }
+
+    return processo;
+}
+
+void encerraProcesso(processo_t *processo)
+{
+    for (int i = 0; i < PAGINAS; i++)
+    {
+        if (processo->tabela[i].quadro != -1)
+        {
+            liberaReferencia(processo->tabela[i].quadro);
+        }
+    }
+
+    contaResidente(processo, -processo->residentes);
+    free(processo->tabela);
+    processo->tabela = NULL;
+    processo->vivo = 0;
+}
+
+void forkProcesso(processo_t *pai, processo_t *filho)
+{
+    forks++;
+
+    // O pid do filho é reaproveitado: o espaço anterior some.
+    for (int i = 0; i < PAGINAS; i++)
+    {
+        struct entradaPagina *entradaPai = &pai->tabela[i];
+
+        if (filho->tabela[i].quadro != -1)
+        {
+            liberaReferencia(filho->tabela[i].quadro);
+            contaResidente(filho, -1);
+        }
+
+        filho->tabela[i] = *entradaPai;
+
+        if (entradaPai->quadro != -1)
+        {
+            referenciasQuadro[entradaPai->quadro]++;
+            contaResidente(filho, 1);
+
+            // Páginas privadas viram COW nos dois processos.
+            if (!entradaPai->compartilhada)
+            {
+                entradaPai->cow = 1;
+                filho->tabela[i].cow = 1;
+            }
+        }
+    }
+}
+
+void mapeiaCompartilhada(processo_t *processo, int pagina, int objeto)
+{
+    struct entradaPagina *entrada = &processo->tabela[pagina];
+
+    if (quadroDoObjeto[objeto] == -1)
+    {
+        // O objeto mantém uma referência própria enquanto a simulação durar.
+        quadroDoObjeto[objeto] = alocaQuadro();
+        carregaPagina(quadroDoObjeto[objeto], objeto);
+    }
+
+    if (entrada->quadro != -1)
+    {
+        liberaReferencia(entrada->quadro);
+    }
+    else
+    {
+        contaResidente(processo, 1);
+    }
+
+    entrada->quadro = quadroDoObjeto[objeto];
+    entrada->cow = 0;
+    entrada->compartilhada = 1;
+    referenciasQuadro[entrada->quadro]++;
+}
+
+/* Traduz um acesso do processo e devolve o quadro usado. */
+int acessa(processo_t *processo, int endereco, int escrita)
+{
+    int pagina = (endereco >> BITS_DESLOCAMENTO) & (PAGINAS - 1);
+    struct entradaPagina *entrada = &processo->tabela[pagina];
+
+    totalReferencias++;
+
+    if (entrada->quadro == -1)
+    {
+        faltasPagina++;
+        entrada->quadro = alocaQuadro();
+        entrada->cow = 0;
+        entrada->compartilhada = 0;
+        carregaPagina(entrada->quadro, pagina);
+        contaResidente(processo, 1);
+    }
+    else if (escrita && entrada->cow)
+    {
+        if (referenciasQuadro[entrada->quadro] == 1)
+        {
+            // Os outros donos já saíram ou copiaram: basta tirar a proteção.
+            reusoCOW++;
+        }
+        else
+        {
+            int antigo = entrada->quadro;
+            int novo = alocaQuadro();
+
+            memcpy(memoria + (size_t) novo * TAMANHO_PAGINA, memoria + (size_t) antigo * TAMANHO_PAGINA, TAMANHO_PAGINA);
+            liberaReferencia(antigo);
+            entrada->quadro = novo;
+            faltasCOW++;
+            bytesCopiados += TAMANHO_PAGINA;
+        }
+        entrada->cow = 0;
+    }
+
+    return entrada->quadro;
+}
+
+// ==================== MAIN ====================
+int main(int argc, const char *argv[])
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "Uso ./copiaNaEscrita entrada backingstore\n");
+        exit(1);
+    }
+
+    int descritorBacking = open(argv[2], O_RDONLY);
+    suporte = mmap(0, TAMANHO_MEMORIA_LOGICA, PROT_READ, MAP_PRIVATE, descritorBacking, 0);
+    if (descritorBacking == -1 || suporte == MAP_FAILED)
+    {
+        fprintf(stderr, "Erro ao mapear o arquivo de backing store %s\n", argv[2]);
+        exit(1);
+    }
+
+    FILE *arquivoEntrada = fopen(argv[1], "r");
+    if (arquivoEntrada == NULL)
+    {
+        fprintf(stderr, "Erro ao abrir o arquivo de entrada %s\n", argv[1]);
+        exit(1);
+    }
+
+    for (int i = 0; i < PAGINAS; i++)
+    {
+        quadroDoObjeto[i] = -1;
+    }
+
+    char buffer[TAMANHO_BUFFER];
+    long linha = 0;
+
+    while (fgets(buffer, TAMANHO_BUFFER, arquivoEntrada) != NULL)
+    {
+        char operacao = 'R';
+        int pid = 0;
+        int a = 0;
+        int b = 0;
+        int campos;
+
+        linha++;
+
+        if (buffer[0] >= '0' && buffer[0] <= '9')
+        {
+            a = atoi(buffer);
+            campos = 3;
+        }
+        else
+        {
+            campos = sscanf(buffer, " %c %d %d %d", &operacao, &pid, &a, &b);
+        }
+
+        if (campos <= 0)
+        {
+            continue;
+        }
+
+        // Todas as operações têm pid e, menos o fim do processo, um endereço ou pid do filho.
+        if (campos < 2 || (operacao != 'X' && campos < 3))
+        {
+            fprintf(stderr, "Linha %ld: operandos faltando\n", linha);
+            continue;
+        }
+
+        processo_t *processo = obtemProcesso(pid);
+        if (processo == NULL)
+        {
+            fprintf(stderr, "Linha %ld: pid inválido\n", linha);
+            continue;
+        }
+
+        switch (operacao)
+        {
+            case 'R':
+                acessa(processo, a, 0);
+                break;
+            case 'W':
+            {
+                int quadro = acessa(processo, a, 1);
+                memoria[(size_t) quadro * TAMANHO_PAGINA + (a & MASCARA_DESLOCAMENTO)] = (unsigned char) (campos == 4 ? b : 0);
+                break;
+            }
+            case 'F':
+            {
+                processo_t *filho = obtemProcesso(a);
+                if (filho == NULL || filho == processo)
+                {
+                    fprintf(stderr, "Linha %ld: pid do filho inválido\n", linha);
+                    break;
+                }
+                forkProcesso(processo, filho);
+                break;
+            }
+            case 'M':
+                if (campos < 4 || a < 0 || a >= PAGINAS || b < 0 || b >= PAGINAS)
+                {
+                    fprintf(stderr, "Linha %ld: mapeamento inválido\n", linha);
+                    break;
+                }
+                mapeiaCompartilhada(processo, a, b);
+                break;
+            case 'X':
+                encerraProcesso(processo);
+                break;
+            default:
+                fprintf(stderr, "Linha %ld: operação desconhecida %c\n", linha, operacao);
+        }
+
+        if (paginasResidentes - quadrosEmUso > maiorEconomia)
+        {
+            maiorEconomia = paginasResidentes - quadrosEmUso;
+        }
+    }
+
+    printf("=====================================\n");
+    printf("Referências = %ld\n", totalReferencias);
+    printf("Forks = %ld\n", forks);
+    printf("Faltas de Página = %ld\n", faltasPagina);
+    printf("Faltas COW = %ld\n", faltasCOW);
+    printf("Escritas COW sem Cópia = %ld\n", reusoCOW);
+    printf("Bytes Copiados = %ld\n", bytesCopiados);
+    printf("Quadros em Uso = %d (pico %ld)\n", quadrosEmUso, picoQuadros);
+    printf("Páginas Residentes sem Compartilhamento = %ld (pico %ld)\n", paginasResidentes, picoResidentes);
+    printf("Memória Economizada = %ld bytes (máximo %ld bytes)\n",
+           (paginasResidentes - quadrosEmUso) * TAMANHO_PAGINA, maiorEconomia * TAMANHO_PAGINA);
+
+    fclose(arquivoEntrada);
+    munmap(suporte, TAMANHO_MEMORIA_LOGICA);
+    close(descritorBacking);
+
+    return 0;
+}
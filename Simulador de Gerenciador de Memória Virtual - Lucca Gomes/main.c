@@ -1,7 +1,8 @@
 /*
   Projeto: Gerenciador de Memória Virtual
   256 páginas no espaço de endereço virtual.
-  256 frames no espaço de memória física.
+  Até 256 frames no espaço de memória física (configurável na linha de comando).
+  Com menos frames que páginas, a substituição usa FIFO, LRU ou CLOCK.
   BACKING_STORE.bin simula um disco rígido.
  */
 
@@ -26,6 +27,11 @@
 #define TAMANHO_MEMORIA (TAMANHO_FRAME * ENTRADAS_FRAME) // Tamanho da memória, em bytes.
 #define TLB_ENTRADAS 16          // Máximo de entradas na TLB.
 
+// Políticas de substituição de páginas.
+#define POLITICA_FIFO 0
+#define POLITICA_LRU 1
+#define POLITICA_CLOCK 2
+
 // ==================== Variáveis Globais ====================
 
 int endereco_virtual;        // Endereço virtual.
@@ -40,12 +46,19 @@ int tlb_inicio = -1; // Índice inicial da TLB, estrutura de dados de fila.
 int tlb_fim = -1;  // Índice final da TLB, estrutura de dados de fila.
 char memoria[TAMANHO_MEMORIA]; // Memória física. Cada char é 1 byte.
 int indice_memoria = 0;  // Aponta para o início do primeiro frame vazio.
+int num_frames = ENTRADAS_FRAME; // Frames em uso, no máximo ENTRADAS_FRAME.
+int politica = POLITICA_FIFO;    // Política de substituição.
+int pagina_do_frame[ENTRADAS_FRAME]; // Página carregada em cada frame.
+int ultimo_acesso[ENTRADAS_FRAME];   // Instante do último acesso a cada frame (LRU).
+char bit_referencia[ENTRADAS_FRAME]; // Bit de referência de cada frame (CLOCK).
+int ponteiro_vitima = 0; // Próximo frame candidato (FIFO e CLOCK).
 
 // ==================== Variáveis de Estatísticas ====================
 
 int contador_page_fault = 0;   // Conta as faltas de página.
 int contador_tlb = 0;     // Contador de acertos da TLB.
 int contador_endereco = 0; // Conta endereços lidos do arquivo.
+int contador_substituicao = 0; // Conta páginas retiradas da memória.
 float taxa_page_fault;        // Taxa de falta de página.
 float taxa_tlb;          // Taxa de acerto da TLB.
 
@@ -58,6 +71,10 @@ void inicializar_tlb(int n);
 int consultar_tabela_paginas(int numero_pagina);
 int consultar_tlb(int numero_pagina);
 void atualizar_tlb(int numero_pagina, int numero_frame);
+void invalidar_tlb(int numero_pagina);
+void registrar_acesso(int numero_frame);
+int escolher_vitima();
+int substituir_pagina();
 
 
 //==================== Funções ====================
@@ -164,6 +181,82 @@ void atualizar_tlb(int numero_pagina, int numero_frame)
     return;
 }
 
+/* Remove da TLB a entrada de numero_pagina, se existir. */
+void invalidar_tlb(int numero_pagina)
+{
+    for (int i = 0; i < TLB_ENTRADAS; i++)
+    {
+        if (tlb[i][0] == numero_pagina)
+        {
+            tlb[i][0] = -1;
+            tlb[i][1] = -1;
+        }
+    }
+}
+
+
+/* Atualiza os dados usados pelas políticas a cada acesso ao frame (numero_frame é o início do frame). */
+void registrar_acesso(int numero_frame)
+{
+    int indice = numero_frame / TAMANHO_FRAME;
+
+    ultimo_acesso[indice] = contador_endereco;
+    bit_referencia[indice] = 1;
+}
+
+
+/* Escolhe, de acordo com a política, o índice do frame que será substituído. */
+int escolher_vitima()
+{
+    int vitima = 0;
+
+    if (politica == POLITICA_LRU)
+    {
+        // Frame com o acesso mais antigo.
+        for (int i = 1; i < num_frames; i++)
+        {
+            if (ultimo_acesso[i] < ultimo_acesso[vitima])
+            {
+                vitima = i;
+            }
+        }
+    }
+    else if (politica == POLITICA_CLOCK)
+    {
+        // Dá uma segunda chance aos frames com o bit de referência ligado.
+        while (bit_referencia[ponteiro_vitima])
+        {
+            bit_referencia[ponteiro_vitima] = 0;
+            ponteiro_vitima = (ponteiro_vitima + 1) % num_frames;
+        }
+        vitima = ponteiro_vitima;
+        ponteiro_vitima = (ponteiro_vitima + 1) % num_frames;
+    }
+    else
+    {
+        // Os frames são ocupados em ordem, então o mais antigo é o próximo da volta.
+        vitima = ponteiro_vitima;
+        ponteiro_vitima = (ponteiro_vitima + 1) % num_frames;
+    }
+
+    return vitima;
+}
+
+
+/* Retira uma página da memória e devolve o início do frame liberado. */
+int substituir_pagina()
+{
+    int vitima = escolher_vitima();
+    int pagina_vitima = pagina_do_frame[vitima];
+
+    // A página sai da tabela de páginas e da TLB.
+    tabela_paginas[pagina_vitima] = -1;
+    invalidar_tlb(pagina_vitima);
+    contador_substituicao++;
+
+    return vitima * TAMANHO_FRAME;
+}
+
 // ==================== MAIN ====================
 
 int main(int argc, char *argv[])
@@ -176,16 +269,16 @@ int main(int argc, char *argv[])
     int fd_armazenamento;       // Descritor de arquivo de armazenamento.
     char linha[8];       // String temporária para armazenar cada linha no arquivo de entrada.
     FILE* ponteiro_entrada;       // Ponteiro do arquivo de endereços.
-    FILE* ponteiro_saida;      // Ponteiro do arquivo de saída.
 
     // Inicializa tabela_paginas, define todos os elementos como -1.
     inicializar_tabela_paginas(-1);
     inicializar_tlb(-1);
 
     // Obtém argumentos da linha de comando.
-    if (argc != 3)
+    if (argc < 3 || argc > 5)
     {
-        printf("Informe os nomes dos arquivos de entrada, saída e armazenamento!");
+        printf("Informe os nomes dos arquivos de entrada e armazenamento!\n");
+        printf("Uso: %s entrada armazenamento [frames] [fifo|lru|clock]\n", argv[0]);
 
         exit(EXIT_FAILURE);
     }
@@ -195,6 +288,36 @@ int main(int argc, char *argv[])
         arquivo_entrada = argv[1];
         arquivo_armazenamento = argv[2];
 
+        // Número de frames e política de substituição opcionais.
+        if (argc > 3)
+        {
+            num_frames = atoi(argv[3]);
+
+            if (num_frames < 1 || num_frames > ENTRADAS_FRAME)
+            {
+                printf("O número de frames deve estar entre 1 e %d.\n", ENTRADAS_FRAME);
+
+                exit(EXIT_FAILURE);
+            }
+        }
+        if (argc > 4)
+        {
+            if (strcmp(argv[4], "lru") == 0)
+            {
+                politica = POLITICA_LRU;
+            }
+            else if (strcmp(argv[4], "clock") == 0)
+            {
+                politica = POLITICA_CLOCK;
+            }
+            else if (strcmp(argv[4], "fifo") != 0)
+            {
+                printf("Política desconhecida: %s\n", argv[4]);
+
+                exit(EXIT_FAILURE);
+            }
+        }
+
         // Abre o arquivo de endereços.
         if ((ponteiro_entrada = fopen(arquivo_entrada, "r")) == NULL)
         {
@@ -245,6 +368,7 @@ int main(int argc, char *argv[])
                 Nenhuma atualização na TLB necessária.
                 */
                 endereco_fisico = numero_frame + deslocamento;
+                registrar_acesso(numero_frame);
 
                 /*
                 Nenhum acesso ao arquivo de armazenamento é necessário
@@ -265,6 +389,7 @@ int main(int argc, char *argv[])
                 {
                     // Sem falta de página.
                     endereco_fisico = numero_frame + deslocamento;
+                    registrar_acesso(numero_frame);
 
                     // Atualiza a TLB.
                     atualizar_tlb(numero_pagina, numero_frame);
@@ -287,27 +412,21 @@ int main(int argc, char *argv[])
                     int endereco_pagina = numero_pagina * TAMANHO_PAGINA;
 
                     // Verifique se um frame livre existe.
-                    if (indice_memoria != -1)
+                    if (indice_memoria == -1)
                     {
                         /*
-                        Sucesso, existe um frame livre.
-                        Armazene a página do arquivo de armazenamento na memória no frame.
+                        Falhou, nenhum frame livre na memória existe.
+                        Troque! A política escolhe uma vítima e o frame dela é reaproveitado.
                         */
-                        memcpy(memoria + indice_memoria, dados_armazenamento + endereco_pagina, TAMANHO_PAGINA);
-
-                        // Calcule o endereço físico de um byte específico.
+                        numero_frame = substituir_pagina();
+                    }
+                    else
+                    {
+                        // Sucesso, existe um frame livre.
                         numero_frame = indice_memoria;
-                        endereco_fisico = numero_frame + deslocamento;
-                        // Obtenha o valor.
-                        valor = memoria[endereco_fisico];
-
-                        // Atualize a tabela_paginas com o número_frame correto.
-                        tabela_paginas[numero_pagina] = indice_memoria;
-                        // Atualize a TLB.
-                        atualizar_tlb(numero_pagina, numero_frame);
 
                         // Incremente indice_memoria.
-                        if (indice_memoria < TAMANHO_MEMORIA - TAMANHO_FRAME)
+                        if (indice_memoria < num_frames * TAMANHO_FRAME - TAMANHO_FRAME)
                         {
                             indice_memoria += TAMANHO_FRAME;
                         }
@@ -317,13 +436,21 @@ int main(int argc, char *argv[])
                             indice_memoria = -1;
                         }
                     }
-                    else
-                    {
-                        /*
-                        Falhou, nenhum frame livre na memória existe.
-                        Troque!
-                        */
-                    }
+
+                    // Armazene a página do arquivo de armazenamento na memória no frame.
+                    memcpy(memoria + numero_frame, dados_armazenamento + endereco_pagina, TAMANHO_PAGINA);
+
+                    // Calcule o endereço físico de um byte específico.
+                    endereco_fisico = numero_frame + deslocamento;
+                    // Obtenha o valor.
+                    valor = memoria[endereco_fisico];
+
+                    // Atualize a tabela_paginas com o número_frame correto.
+                    tabela_paginas[numero_pagina] = numero_frame;
+                    pagina_do_frame[numero_frame / TAMANHO_FRAME] = numero_pagina;
+                    registrar_acesso(numero_frame);
+                    // Atualize a TLB.
+                    atualizar_tlb(numero_pagina, numero_frame);
                 }
             }
 
@@ -343,10 +470,11 @@ int main(int argc, char *argv[])
         printf("Taxa de Page Fault = %.3f\n", taxa_page_fault);
         printf("TLB Hits = %d\n", contador_tlb);
         printf("Taxa de TLB Hit = %.3f\n", taxa_tlb);
+        printf("Substituições = %d\n", contador_substituicao);
 
-        // Feche os três arquivos.
+        // Feche os arquivos.
         fclose(ponteiro_entrada);
-        fclose(ponteiro_saida);
+        munmap(dados_armazenamento, TAMANHO_MEMORIA);
         close(fd_armazenamento);
     }
 
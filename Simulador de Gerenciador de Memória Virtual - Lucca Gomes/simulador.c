@@ -0,0 +1,1202 @@
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "simulador.h"
+#include "trace.h"
+
+#ifdef __AVX2__
+#define BLOCO_TLB 8 // Endereços decodificados e procurados na TLB de uma vez (um registrador AVX2).
+#define BLOCO_CONTADORES 16
+#else
+#define BLOCO_TLB 4 // Sem AVX2, um registrador SSE2 comporta 4 inteiros.
+#define BLOCO_CONTADORES 8
+#endif
+
+// Vetor de BLOCO_TLB inteiros (extensão de vetores do GCC/Clang, vira AVX2/SSE conforme o alvo).
+typedef int vetorInt_t __attribute__((vector_size(BLOCO_TLB * sizeof(int))));
+
+// Contadores do envelhecimento, um registrador inteiro por vez.
+typedef uint16_t vetorContador_t __attribute__((vector_size(BLOCO_CONTADORES * sizeof(uint16_t))));
+
+/*
+ No envelhecimento o bit mais alto do contador é o bit de referência do período atual:
+ um acesso o liga e o deslocamento do fim do período o empurra para o histórico.
+ */
+#define CONTADOR_REFERENCIA 0x8000
+#define CONTADOR_VAZIO UINT16_MAX  // Preenchimento depois do último quadro, nunca é o mínimo.
+
+//==================== Structs ====================
+
+/*
+ Entrada da tabela de páginas, com todos os metadados da página em 64 bits:
+   bits 0-23   quadro
+   bit 24      presente
+   bit 25      referenciada: ligado a cada acesso, limpo pelo ponteiro do relógio
+   bit 26      suja: ligado por uma escrita, a página é gravada de volta ao ser substituída
+   bit 27      liberada: o quadro foi liberado por unmap/DONTNEED
+   bit 28      pré-carregada por WILLNEED e ainda não acessada
+   bits 32-63  idade: valor do relógio de referências no último acesso (LRU)
+ */
+typedef uint64_t entradaPagina_t;
+
+#define PTE_BITS_QUADRO 24
+#define PTE_QUADRO ((1ULL << PTE_BITS_QUADRO) - 1)
+#define PTE_PRESENTE (1ULL << 24)
+#define PTE_REFERENCIADA (1ULL << 25)
+#define PTE_SUJA (1ULL << 26)
+#define PTE_LIBERADA (1ULL << 27)
+#define PTE_PRECARREGADA (1ULL << 28)
+#define PTE_DESLOCAMENTO_IDADE 32
+
+struct entradaTLB
+{
+    int logica;
+    int fisica;
+};
+
+#define CHECKPOINT_MAGICA "CKP3"
+
+/*
+ Início do arquivo de checkpoint. As demais partes do estado ficam nos offsets
+ indicados. Só é garantido restaurar com o mesmo binário que gravou.
+ */
+typedef struct
+{
+    char magica[4];
+    uint32_t tamanhoCabecalho;   // sizeof(cabecalhoCheckpoint_t) de quem gravou.
+    configSimulador_t config;
+    int indiceTLB;
+    int numQuadrosLivres;
+    int proximoQuadroFIFO;
+    uint32_t relogio;
+    int referenciasEpoca;
+    int referenciasPeriodo;
+    estatisticasSimulador_t estatisticas;
+    uint64_t offsetTLB;
+    uint64_t offsetTabela;
+    uint64_t offsetQuadros;      // paginaDoQuadro seguido de acessosQuadro.
+    uint64_t offsetContadores;
+    uint64_t offsetLivres;
+    uint64_t offsetMemoria;
+    uint64_t tamanho;            // Tamanho total do arquivo.
+} cabecalhoCheckpoint_t;
+
+struct simulador
+{
+    configSimulador_t config;
+
+    int tamanhoPagina;
+    int mascaraDeslocamento;
+    int mascaraPagina;
+    int totalQuadros;            // Quadros das duas camadas.
+
+    struct entradaTLB *tlb;
+    int indiceTLB;
+    entradaPagina_t *tabelaPaginas;
+    uint32_t relogio;            // Referências desde a última renumeração das idades.
+    unsigned char *memoriaPrincipal;
+
+    suporte_t *suporte;
+
+    int numQuadrosLivres;
+    int proximoQuadroFIFO;
+    uint64_t *quadrosLivres;     // Bitmap: bit ligado é quadro livre.
+    int palavrasLivres;
+    int palavraLivre;            // Nenhuma palavra antes desta tem bit ligado.
+
+    // Memória em camadas.
+    int *paginaDoQuadro;         // Página carregada em cada quadro, ou -1.
+    unsigned int *acessosQuadro; // Acessos de cada quadro, divididos por 2 a cada época.
+    int referenciasEpoca;
+    unsigned char *bufferTroca;  // Uma página, usada para trocar dois quadros.
+
+    // Envelhecimento.
+    uint16_t *contadores;        // Um por quadro, completado com CONTADOR_VAZIO até numContadores.
+    int numContadores;           // totalQuadros arredondado para múltiplo de BLOCO_CONTADORES.
+    int referenciasPeriodo;
+
+    cabecalhoCheckpoint_t *checkpoint; // Checkpoint mapeado, ou MAP_FAILED.
+
+    estatisticasSimulador_t estatisticas;
+};
+
+//==================== Tabela de Páginas ====================
+
+static inline int pteQuadro(entradaPagina_t entrada)
+{
+    return (entrada & PTE_PRESENTE) ? (int) (entrada & PTE_QUADRO) : -1;
+}
+
+static inline uint32_t pteIdade(entradaPagina_t entrada)
+{
+    return (uint32_t) (entrada >> PTE_DESLOCAMENTO_IDADE);
+}
+
+static inline entradaPagina_t pteMudaQuadro(entradaPagina_t entrada, int quadro)
+{
+    return (entrada & ~PTE_QUADRO) | (entradaPagina_t) quadro;
+}
+
+static int comparaIdade(const void *a, const void *b)
+{
+    uint32_t x = pteIdade(**(entradaPagina_t *const *) a);
+    uint32_t y = pteIdade(**(entradaPagina_t *const *) b);
+
+    return (x > y) - (x < y);
+}
+
+/*
+ Antes do relógio de 32 bits dar a volta, troca as idades das páginas presentes
+ por 0..n-1 na mesma ordem, preservando a ordem do LRU.
+ */
+static void renumeraIdades(simulador_t *sim)
+{
+    entradaPagina_t **presentes = malloc(sizeof(entradaPagina_t *) * sim->totalQuadros);
+    int n = 0;
+
+    for (int q = 0; q < sim->totalQuadros; q++)
+    {
+        if (sim->paginaDoQuadro[q] != -1)
+        {
+            presentes[n++] = &sim->tabelaPaginas[sim->paginaDoQuadro[q]];
+        }
+    }
+    qsort(presentes, n, sizeof(entradaPagina_t *), comparaIdade);
+
+    for (int i = 0; i < n; i++)
+    {
+        *presentes[i] = (*presentes[i] & ((1ULL << PTE_DESLOCAMENTO_IDADE) - 1)) |
+                        ((entradaPagina_t) i << PTE_DESLOCAMENTO_IDADE);
+    }
+    sim->relogio = (uint32_t) n;
+
+    free(presentes);
+}
+
+/* Marca a página como referenciada agora. */
+static inline void registraAcesso(simulador_t *sim, int pagina)
+{
+    if (sim->relogio == UINT32_MAX)
+    {
+        renumeraIdades(sim);
+    }
+
+    entradaPagina_t *entrada = &sim->tabelaPaginas[pagina];
+    if (*entrada & PTE_PRECARREGADA)
+    {
+        sim->estatisticas.preCarregamentosUsados++;
+        *entrada &= ~PTE_PRECARREGADA;
+    }
+    *entrada = (*entrada & ((1ULL << PTE_DESLOCAMENTO_IDADE) - 1)) | PTE_REFERENCIADA |
+               ((entradaPagina_t) sim->relogio++ << PTE_DESLOCAMENTO_IDADE);
+}
+
+//==================== Quadros Livres ====================
+
+/* Menor quadro livre (find-first-set no bitmap), ou -1 se a memória está cheia. */
+static int alocaQuadro(simulador_t *sim)
+{
+    for (int w = sim->palavraLivre; w < sim->palavrasLivres; w++)
+    {
+        if (sim->quadrosLivres[w] != 0)
+        {
+            int quadro = w * 64 + __builtin_ffsll((long long) sim->quadrosLivres[w]) - 1;
+            sim->quadrosLivres[w] &= sim->quadrosLivres[w] - 1;
+            sim->palavraLivre = w;
+            sim->numQuadrosLivres--;
+
+            long emUso = sim->totalQuadros - sim->numQuadrosLivres;
+            if (emUso > sim->estatisticas.picoQuadrosEmUso)
+            {
+                sim->estatisticas.picoQuadrosEmUso = emUso;
+            }
+
+            return quadro;
+        }
+    }
+    sim->palavraLivre = sim->palavrasLivres;
+
+    return -1;
+}
+
+static void liberaQuadro(simulador_t *sim, int quadro)
+{
+    sim->quadrosLivres[quadro / 64] |= 1ULL << (quadro % 64);
+    sim->numQuadrosLivres++;
+    if (quadro / 64 < sim->palavraLivre)
+    {
+        sim->palavraLivre = quadro / 64;
+    }
+}
+
+/* Deixa o bit do quadro de acordo com a ocupação dele (livre é sem página). */
+static void atualizaQuadroLivre(simulador_t *sim, int quadro)
+{
+    if (sim->paginaDoQuadro[quadro] == -1)
+    {
+        if (!(sim->quadrosLivres[quadro / 64] & (1ULL << (quadro % 64))))
+        {
+            liberaQuadro(sim, quadro);
+        }
+    }
+    else if (sim->quadrosLivres[quadro / 64] & (1ULL << (quadro % 64)))
+    {
+        sim->quadrosLivres[quadro / 64] &= ~(1ULL << (quadro % 64));
+        sim->numQuadrosLivres--;
+    }
+}
+
+//==================== TLB ====================
+
+static int buscaTLB(simulador_t *sim, int paginaLogica)
+{
+    for(int i = 0; i < sim->config.entradasTLB; i++)
+    {
+        if(sim->tlb[i].logica == paginaLogica)
+        {
+            return sim->tlb[i].fisica;
+        }
+    }
+
+    return -1;
+}
+
+static void adicionaTLB(simulador_t *sim, int pagina, int quadro)
+{
+    for(int i = 0; i < sim->config.entradasTLB; i++)
+    {
+        if(sim->tlb[i].fisica == quadro)
+        {
+            sim->tlb[i].logica = pagina;
+            return;
+        }
+    }
+
+    sim->tlb[sim->indiceTLB % sim->config.entradasTLB].logica = pagina;
+    sim->tlb[sim->indiceTLB % sim->config.entradasTLB].fisica = quadro;
+    sim->indiceTLB++;
+}
+
+static void invalidaTLBQuadro(simulador_t *sim, int quadro)
+{
+    for(int i = 0; i < sim->config.entradasTLB; i++)
+    {
+        if(sim->tlb[i].fisica == quadro)
+        {
+            sim->tlb[i].logica = -1;
+            sim->tlb[i].fisica = -1;
+        }
+    }
+}
+
+//==================== Substituição ====================
+
+static int substituicaoFIFO(simulador_t *sim)
+{
+    return sim->paginaDoQuadro[sim->proximoQuadroFIFO];
+}
+
+/*
+ Segunda chance: o ponteiro do FIFO dá a volta nos quadros limpando o bit de
+ referência e para na primeira página que não foi referenciada desde a última passagem.
+ */
+static int substituicaoRelogio(simulador_t *sim)
+{
+    while (1)
+    {
+        int pagina = sim->paginaDoQuadro[sim->proximoQuadroFIFO];
+        if ((sim->tabelaPaginas[pagina] & PTE_REFERENCIADA) == 0)
+        {
+            return pagina;
+        }
+
+        sim->tabelaPaginas[pagina] &= ~PTE_REFERENCIADA;
+        sim->proximoQuadroFIFO = (sim->proximoQuadroFIFO + 1) % sim->totalQuadros;
+    }
+}
+
+/* A vítima é a página presente com o último acesso mais antigo. */
+static int substituicaoLRU(simulador_t *sim)
+{
+    int vitima = sim->paginaDoQuadro[0];
+    uint32_t menorIdade = pteIdade(sim->tabelaPaginas[vitima]);
+
+    for (int q = 1; q < sim->totalQuadros; q++)
+    {
+        uint32_t idade = pteIdade(sim->tabelaPaginas[sim->paginaDoQuadro[q]]);
+        if (idade < menorIdade)
+        {
+            menorIdade = idade;
+            vitima = sim->paginaDoQuadro[q];
+        }
+    }
+
+    return vitima;
+}
+
+/* Desloca todos os contadores de uma vez, trazendo o bit de referência para o histórico. */
+static void envelheceContadores(simulador_t *sim)
+{
+    for (int i = 0; i < sim->numContadores; i += BLOCO_CONTADORES)
+    {
+        vetorContador_t contadores;
+        memcpy(&contadores, sim->contadores + i, sizeof(contadores));
+        contadores >>= 1;
+        memcpy(sim->contadores + i, &contadores, sizeof(contadores));
+    }
+
+    for (int q = sim->totalQuadros; q < sim->numContadores; q++)
+    {
+        sim->contadores[q] = CONTADOR_VAZIO;
+    }
+}
+
+/* A vítima é o quadro de menor contador (o primeiro, em caso de empate), achado com mínimos vetoriais. */
+static int substituicaoEnvelhecimento(simulador_t *sim)
+{
+    vetorContador_t minimos;
+    memcpy(&minimos, sim->contadores, sizeof(minimos));
+
+    for (int i = BLOCO_CONTADORES; i < sim->numContadores; i += BLOCO_CONTADORES)
+    {
+        vetorContador_t contadores;
+        memcpy(&contadores, sim->contadores + i, sizeof(contadores));
+        vetorContador_t menor = (vetorContador_t) (contadores < minimos);
+        minimos = (contadores & menor) | (minimos & ~menor);
+    }
+
+    uint16_t lanes[BLOCO_CONTADORES];
+    memcpy(lanes, &minimos, sizeof(lanes));
+    uint16_t minimo = lanes[0];
+    for (int j = 1; j < BLOCO_CONTADORES; j++)
+    {
+        minimo = lanes[j] < minimo ? lanes[j] : minimo;
+    }
+
+    // Primeiro bloco que contém o mínimo, e a posição dele dentro do bloco.
+    for (int i = 0; i < sim->numContadores; i += BLOCO_CONTADORES)
+    {
+        vetorContador_t contadores;
+        memcpy(&contadores, sim->contadores + i, sizeof(contadores));
+        vetorContador_t igual = (vetorContador_t) (contadores == minimo);
+        memcpy(lanes, &igual, sizeof(lanes));
+
+        for (int j = 0; j < BLOCO_CONTADORES; j++)
+        {
+            if (lanes[j])
+            {
+                return sim->paginaDoQuadro[i + j];
+            }
+        }
+    }
+
+    return -1;
+}
+
+static int substituicao(simulador_t *sim)
+{
+    int paginaAntiga = 0;
+
+    if(sim->config.politica == POLITICA_LRU)
+    {
+        paginaAntiga = substituicaoLRU(sim);
+    }
+    else if(sim->config.politica == POLITICA_ENVELHECIMENTO)
+    {
+        paginaAntiga = substituicaoEnvelhecimento(sim);
+    }
+    else if(sim->config.politica == POLITICA_RELOGIO)
+    {
+        paginaAntiga = substituicaoRelogio(sim);
+    }
+    else
+    {
+        paginaAntiga = substituicaoFIFO(sim);
+    }
+
+    // O trace não diz o valor escrito, então só o custo da gravação de volta é contado.
+    if (sim->tabelaPaginas[paginaAntiga] & PTE_SUJA)
+    {
+        sim->estatisticas.escritasDeVolta++;
+    }
+
+    int quadro = pteQuadro(sim->tabelaPaginas[paginaAntiga]);
+    sim->tabelaPaginas[paginaAntiga] = 0;
+
+    return quadro;
+}
+
+//==================== Tradução ====================
+
+/* Registra o acesso ao quadro já resolvido e devolve o endereço físico e o byte lido em *valor. */
+static int acessaQuadro(simulador_t *sim, int pagina, int quadro, int deslocamento, unsigned char *valor)
+{
+    registraAcesso(sim, pagina);
+
+    if (sim->config.politica == POLITICA_ENVELHECIMENTO)
+    {
+        sim->contadores[quadro] |= CONTADOR_REFERENCIA;
+        if (++sim->referenciasPeriodo == sim->config.periodoEnvelhecimento)
+        {
+            sim->referenciasPeriodo = 0;
+            envelheceContadores(sim);
+        }
+    }
+
+    sim->acessosQuadro[quadro]++;
+    if (quadro < sim->config.quadros)
+    {
+        sim->estatisticas.acessosRapidos++;
+    }
+    else
+    {
+        sim->estatisticas.acessosLentos++;
+    }
+
+    *valor = sim->memoriaPrincipal[(size_t) quadro * sim->tamanhoPagina + deslocamento];
+
+    return (quadro << sim->config.bitsDeslocamento) | deslocamento;
+}
+
+/* Coloca a página em um quadro livre ou no quadro da vítima da política. Retorna o quadro. */
+static int carregaPagina(simulador_t *sim, int pagina)
+{
+    int quadro = alocaQuadro(sim);
+    if (quadro == -1)
+    {
+        quadro = substituicao(sim);
+        sim->estatisticas.substituicoes++;
+    }
+    sim->proximoQuadroFIFO = (sim->proximoQuadroFIFO + 1) % sim->totalQuadros;
+
+    unsigned char *destino = sim->memoriaPrincipal + ((size_t) quadro * sim->tamanhoPagina);
+    if (suporteCarrega(sim->suporte, pagina, destino) == -1)
+    {
+        // Erro de leitura: a página fica zerada, como um trecho além do fim do arquivo.
+        memset(destino, 0, sim->tamanhoPagina);
+    }
+    sim->tabelaPaginas[pagina] = PTE_PRESENTE | (entradaPagina_t) quadro;
+    sim->paginaDoQuadro[quadro] = pagina;
+    sim->acessosQuadro[quadro] = 0;
+    sim->contadores[quadro] = 0;
+
+    return quadro;
+}
+
+/* Tira a página da memória e devolve o quadro ao alocador. */
+static void liberaPagina(simulador_t *sim, int pagina)
+{
+    int quadro = pteQuadro(sim->tabelaPaginas[pagina]);
+    if (quadro == -1)
+    {
+        return;
+    }
+
+    invalidaTLBQuadro(sim, quadro);
+    sim->tabelaPaginas[pagina] = PTE_LIBERADA;
+    sim->paginaDoQuadro[quadro] = -1;
+    sim->acessosQuadro[quadro] = 0;
+    sim->contadores[quadro] = 0;
+    liberaQuadro(sim, quadro);
+    sim->estatisticas.quadrosLiberados++;
+}
+
+/* Executa uma operação unmap/DONTNEED/WILLNEED do trace sobre a página do endereço. */
+static void executaOperacao(simulador_t *sim, int operacao)
+{
+    int pagina = (traceEnderecoOperacao(operacao) >> sim->config.bitsDeslocamento) & sim->mascaraPagina;
+
+    sim->estatisticas.operacoes++;
+
+    switch (traceTipoOperacao(operacao))
+    {
+        case TRACE_OPERACAO_UNMAP:
+            sim->estatisticas.operacoesUnmap++;
+            liberaPagina(sim, pagina);
+            break;
+
+        case TRACE_OPERACAO_DONTNEED:
+            sim->estatisticas.operacoesDontneed++;
+            liberaPagina(sim, pagina);
+            break;
+
+        case TRACE_OPERACAO_WILLNEED:
+            sim->estatisticas.operacoesWillneed++;
+            if (pteQuadro(sim->tabelaPaginas[pagina]) == -1)
+            {
+                // A página não passa pela TLB, então uma entrada antiga do quadro não pode ficar.
+                int quadro = carregaPagina(sim, pagina);
+                invalidaTLBQuadro(sim, quadro);
+
+                // Entra como a mais recente, sem contar como referência, para não ser a próxima vítima.
+                sim->tabelaPaginas[pagina] |= PTE_PRECARREGADA | PTE_REFERENCIADA |
+                                              ((entradaPagina_t) sim->relogio << PTE_DESLOCAMENTO_IDADE);
+                sim->contadores[quadro] = CONTADOR_REFERENCIA;
+                sim->estatisticas.preCarregamentos++;
+            }
+            break;
+    }
+}
+
+/*
+ Traduz um único endereço lógico, devolvendo o endereço físico, o byte lido em *valor
+ e em *flags se houve acerto na TLB ou falta de página. Operações devolvem -1.
+ */
+static int traduz(simulador_t *sim, int enderecoLogico, unsigned char *valor, unsigned char *flags)
+{
+    if (traceEhOperacao(enderecoLogico))
+    {
+        executaOperacao(sim, enderecoLogico);
+        *valor = 0;
+        *flags = RESULTADO_OPERACAO;
+
+        return -1;
+    }
+
+    sim->estatisticas.totalEnderecos++;
+    *flags = 0;
+
+    int escrita = enderecoLogico < 0;
+    enderecoLogico = traceEndereco(enderecoLogico);
+
+    int deslocamento = enderecoLogico & sim->mascaraDeslocamento;
+    int pagina = (enderecoLogico >> sim->config.bitsDeslocamento) & sim->mascaraPagina;
+    int quadro = buscaTLB(sim, pagina);
+
+    if (quadro != -1)
+    {
+        sim->estatisticas.acertosTLB++;
+        *flags = RESULTADO_ACERTO_TLB;
+    }
+    else
+    {
+        quadro = pteQuadro(sim->tabelaPaginas[pagina]);
+        if (quadro == -1)
+        {
+            sim->estatisticas.faltasPagina++;
+            sim->estatisticas.faltasAposLiberacao += (sim->tabelaPaginas[pagina] & PTE_LIBERADA) != 0;
+            *flags = RESULTADO_FALTA_PAGINA;
+            quadro = carregaPagina(sim, pagina);
+        }
+        adicionaTLB(sim, pagina, quadro);
+    }
+
+    int fisico = acessaQuadro(sim, pagina, quadro, deslocamento, valor);
+    if (escrita)
+    {
+        sim->tabelaPaginas[pagina] |= PTE_SUJA;
+        sim->estatisticas.escritas++;
+        *flags |= RESULTADO_ESCRITA;
+    }
+
+    return fisico;
+}
+
+/*
+ Decodifica um bloco de BLOCO_TLB endereços com operações vetoriais (shift e máscara)
+ e procura todas as páginas na TLB com comparações vetoriais.
+ quadros[j] recebe -1 quando a página de enderecos[j] não está na TLB.
+ */
+static void buscaTLBBloco(const simulador_t *sim, const int *enderecos, int *paginas, int *deslocamentos, int *quadros)
+{
+    vetorInt_t enderecosV;
+    memcpy(&enderecosV, enderecos, sizeof(enderecosV));
+
+    vetorInt_t deslocamentosV = enderecosV & sim->mascaraDeslocamento;
+    vetorInt_t paginasV = (enderecosV >> sim->config.bitsDeslocamento) & sim->mascaraPagina;
+    vetorInt_t quadrosV = paginasV * 0 - 1;
+
+    // Percorre a TLB de trás para frente para que a primeira entrada igual prevaleça, como em buscaTLB.
+    for (int i = sim->config.entradasTLB - 1; i >= 0; i--)
+    {
+        vetorInt_t igual = paginasV == sim->tlb[i].logica;
+        quadrosV = (igual & sim->tlb[i].fisica) | (~igual & quadrosV);
+    }
+
+    memcpy(paginas, &paginasV, sizeof(paginasV));
+    memcpy(deslocamentos, &deslocamentosV, sizeof(deslocamentosV));
+    memcpy(quadros, &quadrosV, sizeof(quadrosV));
+}
+
+//==================== Memória em Camadas ====================
+
+typedef struct
+{
+    int quadro;
+    unsigned int acessos;
+} quadroAcessos_t;
+
+static int comparaMaisAcessados(const void *a, const void *b)
+{
+    const quadroAcessos_t *x = a;
+    const quadroAcessos_t *y = b;
+
+    return (x->acessos < y->acessos) - (x->acessos > y->acessos);
+}
+
+static int comparaMenosAcessados(const void *a, const void *b)
+{
+    return comparaMaisAcessados(b, a);
+}
+
+/* Troca o conteúdo de dois quadros, atualizando tabela de páginas, TLB e contadores. */
+static void trocaQuadros(simulador_t *sim, int a, int b)
+{
+    unsigned char *quadroA = sim->memoriaPrincipal + (size_t) a * sim->tamanhoPagina;
+    unsigned char *quadroB = sim->memoriaPrincipal + (size_t) b * sim->tamanhoPagina;
+
+    memcpy(sim->bufferTroca, quadroA, sim->tamanhoPagina);
+    memcpy(quadroA, quadroB, sim->tamanhoPagina);
+    memcpy(quadroB, sim->bufferTroca, sim->tamanhoPagina);
+
+    int paginaA = sim->paginaDoQuadro[a];
+    int paginaB = sim->paginaDoQuadro[b];
+    sim->paginaDoQuadro[a] = paginaB;
+    sim->paginaDoQuadro[b] = paginaA;
+    if (paginaA != -1)
+    {
+        sim->tabelaPaginas[paginaA] = pteMudaQuadro(sim->tabelaPaginas[paginaA], b);
+    }
+    if (paginaB != -1)
+    {
+        sim->tabelaPaginas[paginaB] = pteMudaQuadro(sim->tabelaPaginas[paginaB], a);
+    }
+
+    unsigned int acessos = sim->acessosQuadro[a];
+    sim->acessosQuadro[a] = sim->acessosQuadro[b];
+    sim->acessosQuadro[b] = acessos;
+
+    uint16_t contador = sim->contadores[a];
+    sim->contadores[a] = sim->contadores[b];
+    sim->contadores[b] = contador;
+
+    // Com quadros liberados, uma página pode ir para um quadro rápido vazio.
+    atualizaQuadroLivre(sim, a);
+    atualizaQuadroLivre(sim, b);
+
+    for (int i = 0; i < sim->config.entradasTLB; i++)
+    {
+        if (sim->tlb[i].fisica == a)
+        {
+            sim->tlb[i].fisica = b;
+        }
+        else if (sim->tlb[i].fisica == b)
+        {
+            sim->tlb[i].fisica = a;
+        }
+    }
+}
+
+/*
+ Rodada de migração: as páginas lentas com pelo menos limiarPromocao acessos são
+ promovidas, em ordem de acessos, trocando de lugar com as páginas rápidas menos
+ acessadas. Para quando a página lenta deixa de ser mais quente que a rápida.
+ Retorna quantas trocas foram feitas.
+ */
+static int migraCamadas(simulador_t *sim)
+{
+    int rapidos = sim->config.quadros;
+    int lentos = sim->config.quadrosLentos;
+    quadroAcessos_t *quentes = malloc(sizeof(quadroAcessos_t) * lentos);
+    quadroAcessos_t *frios = malloc(sizeof(quadroAcessos_t) * rapidos);
+    int numQuentes = 0;
+    int trocas = 0;
+
+    for (int q = rapidos; q < sim->totalQuadros; q++)
+    {
+        if (sim->paginaDoQuadro[q] != -1 && sim->acessosQuadro[q] >= (unsigned int) sim->config.limiarPromocao)
+        {
+            quentes[numQuentes].quadro = q;
+            quentes[numQuentes].acessos = sim->acessosQuadro[q];
+            numQuentes++;
+        }
+    }
+
+    if (numQuentes > 0)
+    {
+        for (int q = 0; q < rapidos; q++)
+        {
+            frios[q].quadro = q;
+            frios[q].acessos = sim->acessosQuadro[q];
+        }
+
+        qsort(quentes, numQuentes, sizeof(quadroAcessos_t), comparaMaisAcessados);
+        qsort(frios, rapidos, sizeof(quadroAcessos_t), comparaMenosAcessados);
+
+        for (int k = 0; k < numQuentes && k < rapidos && trocas < sim->config.maxMigracoesEpoca; k++)
+        {
+            if (quentes[k].acessos <= frios[k].acessos)
+            {
+                break;
+            }
+
+            int tinhaPagina = sim->paginaDoQuadro[frios[k].quadro] != -1;
+            trocaQuadros(sim, quentes[k].quadro, frios[k].quadro);
+
+            sim->estatisticas.promocoes++;
+            sim->estatisticas.rebaixamentos += tinhaPagina;
+            sim->estatisticas.bytesMigrados += (long) sim->tamanhoPagina * (1 + tinhaPagina);
+            sim->estatisticas.custoMigracoes += (double) sim->config.custoMigracao * (1 + tinhaPagina);
+            trocas++;
+        }
+    }
+
+    free(quentes);
+    free(frios);
+
+    return trocas;
+}
+
+/*
+ Conta uma referência na época atual e, no fim da época, faz a rodada de migração
+ e envelhece os contadores. Retorna o número de trocas, que mudam os quadros das
+ páginas e invalidam quadros já procurados na TLB.
+ */
+static int avancaEpoca(simulador_t *sim)
+{
+    if (sim->config.quadrosLentos == 0 || ++sim->referenciasEpoca < sim->config.epocaMigracao)
+    {
+        return 0;
+    }
+
+    sim->referenciasEpoca = 0;
+    int trocas = migraCamadas(sim);
+
+    for (int q = 0; q < sim->totalQuadros; q++)
+    {
+        sim->acessosQuadro[q] >>= 1;
+    }
+
+    return trocas;
+}
+
+//==================== API ====================
+
+void simuladorConfigPadrao(configSimulador_t *config)
+{
+    config->bitsDeslocamento = 10;
+    config->paginas = 1024;
+    config->quadros = 256;
+    config->entradasTLB = 16;
+    config->politica = POLITICA_FIFO;
+    config->periodoEnvelhecimento = 64;
+    config->processamentoBloco = 1;
+    config->motorES = MOTOR_MMAP;
+    config->paginasCacheES = 64;
+    config->quadrosLentos = 0;
+    config->latenciaRapida = 80;
+    config->latenciaLenta = 250;
+    config->custoMigracao = 1000;
+    config->epocaMigracao = 10000;
+    config->limiarPromocao = 8;
+    config->maxMigracoesEpoca = 32;
+    config->latenciaTLB = 1;
+    config->latenciaTabela = 100;
+    config->latenciaFalta = 100000;
+    config->latenciaEscrita = 100000;
+    config->arquivoBacking = "BACKING_STORE.bin";
+}
+
+/* Valida a configuração e aloca o simulador com os campos derivados dela. */
+static simulador_t *alocaSimulador(const configSimulador_t *config)
+{
+    // A máscara de página só funciona com potências de 2.
+    if (config->bitsDeslocamento <= 0 || config->paginas <= 0 || (config->paginas & (config->paginas - 1)) != 0 ||
+        config->quadros <= 0 || config->entradasTLB <= 0 || config->quadrosLentos < 0 ||
+        (long) config->quadros + config->quadrosLentos > (long) PTE_QUADRO + 1 ||
+        (config->quadrosLentos > 0 && config->epocaMigracao <= 0) ||
+        (config->politica == POLITICA_ENVELHECIMENTO && config->periodoEnvelhecimento <= 0))
+    {
+        return NULL;
+    }
+
+    simulador_t *sim = calloc(1, sizeof(simulador_t));
+    if (sim == NULL)
+    {
+        return NULL;
+    }
+
+    sim->config = *config;
+    sim->config.arquivoBacking = NULL;
+    sim->tamanhoPagina = 1 << config->bitsDeslocamento;
+    sim->mascaraDeslocamento = sim->tamanhoPagina - 1;
+    sim->mascaraPagina = config->paginas - 1;
+    sim->totalQuadros = config->quadros + config->quadrosLentos;
+    sim->numContadores = (sim->totalQuadros + BLOCO_CONTADORES - 1) / BLOCO_CONTADORES * BLOCO_CONTADORES;
+    sim->palavrasLivres = (sim->totalQuadros + 63) / 64;
+    sim->numQuadrosLivres = sim->totalQuadros;
+    sim->suporte = NULL;
+    sim->checkpoint = MAP_FAILED;
+
+    sim->bufferTroca = malloc(sim->tamanhoPagina);
+    if (sim->bufferTroca == NULL)
+    {
+        free(sim);
+        return NULL;
+    }
+
+    return sim;
+}
+
+/* Abre o BACKING_STORE com o motor de E/S da configuração. Retorna 0 ou -1. */
+static int abreBacking(simulador_t *sim, const char *arquivoBacking)
+{
+    sim->suporte = suporteAbre(arquivoBacking, sim->config.motorES, sim->tamanhoPagina, sim->config.paginas,
+                               sim->config.paginasCacheES);
+
+    return sim->suporte == NULL ? -1 : 0;
+}
+
+simulador_t *simuladorCria(const configSimulador_t *config)
+{
+    simulador_t *sim = alocaSimulador(config);
+    if (sim == NULL)
+    {
+        return NULL;
+    }
+
+    sim->tlb = malloc(sizeof(struct entradaTLB) * config->entradasTLB);
+    sim->tabelaPaginas = calloc(config->paginas, sizeof(entradaPagina_t));
+    sim->memoriaPrincipal = calloc((size_t) sim->totalQuadros, sim->tamanhoPagina);
+    sim->paginaDoQuadro = malloc(sizeof(int) * sim->totalQuadros);
+    sim->acessosQuadro = calloc(sim->totalQuadros, sizeof(unsigned int));
+    sim->contadores = calloc(sim->numContadores, sizeof(uint16_t));
+    sim->quadrosLivres = calloc(sim->palavrasLivres, sizeof(uint64_t));
+    if (sim->tlb == NULL || sim->tabelaPaginas == NULL || sim->memoriaPrincipal == NULL ||
+        sim->paginaDoQuadro == NULL || sim->acessosQuadro == NULL || sim->contadores == NULL ||
+        sim->quadrosLivres == NULL)
+    {
+        simuladorDestroi(sim);
+        return NULL;
+    }
+
+    for (int i = 0; i < config->entradasTLB; i++)
+    {
+        sim->tlb[i].logica = -1;
+        sim->tlb[i].fisica = -1;
+    }
+
+    for (int i = 0; i < sim->totalQuadros; i++)
+    {
+        sim->paginaDoQuadro[i] = -1;
+        sim->quadrosLivres[i / 64] |= 1ULL << (i % 64);
+    }
+
+    for (int i = sim->totalQuadros; i < sim->numContadores; i++)
+    {
+        sim->contadores[i] = CONTADOR_VAZIO;
+    }
+
+    if (abreBacking(sim, config->arquivoBacking) == -1)
+    {
+        simuladorDestroi(sim);
+        return NULL;
+    }
+
+    return sim;
+}
+
+void simuladorDestroi(simulador_t *sim)
+{
+    if (sim == NULL)
+    {
+        return;
+    }
+
+    suporteFecha(sim->suporte);
+
+    if (sim->checkpoint != MAP_FAILED)
+    {
+        // TLB, tabela de páginas e memória apontam para dentro do checkpoint mapeado.
+        munmap(sim->checkpoint, sim->checkpoint->tamanho);
+    }
+    else
+    {
+        free(sim->tlb);
+        free(sim->tabelaPaginas);
+        free(sim->memoriaPrincipal);
+        free(sim->paginaDoQuadro);
+        free(sim->acessosQuadro);
+        free(sim->contadores);
+        free(sim->quadrosLivres);
+    }
+    free(sim->bufferTroca);
+    free(sim);
+}
+
+//==================== Checkpoint ====================
+
+static size_t alinha(size_t valor, size_t alinhamento)
+{
+    return (valor + alinhamento - 1) / alinhamento * alinhamento;
+}
+
+/* Calcula onde cada parte do estado fica dentro do arquivo de checkpoint. */
+static void layoutCheckpoint(const simulador_t *sim, cabecalhoCheckpoint_t *cabecalho)
+{
+    size_t posicao = alinha(sizeof(cabecalhoCheckpoint_t), 64);
+
+    cabecalho->offsetTLB = posicao;
+    posicao = alinha(posicao + sizeof(struct entradaTLB) * sim->config.entradasTLB, 64);
+
+    cabecalho->offsetTabela = posicao;
+    posicao = alinha(posicao + sizeof(entradaPagina_t) * sim->config.paginas, 64);
+
+    cabecalho->offsetQuadros = posicao;
+    posicao = alinha(posicao + (sizeof(int) + sizeof(unsigned int)) * sim->totalQuadros, 64);
+
+    cabecalho->offsetContadores = posicao;
+    posicao = alinha(posicao + sizeof(uint16_t) * sim->numContadores, 64);
+
+    cabecalho->offsetLivres = posicao;
+    posicao = alinha(posicao + sizeof(uint64_t) * sim->palavrasLivres, 4096);
+
+    // A memória física começa em uma página própria para ser mapeada sem cópia.
+    cabecalho->offsetMemoria = posicao;
+    cabecalho->tamanho = posicao + (size_t) sim->totalQuadros * sim->tamanhoPagina;
+}
+
+int simuladorSalva(const simulador_t *sim, const char *caminho)
+{
+    cabecalhoCheckpoint_t cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+
+    memcpy(cabecalho.magica, CHECKPOINT_MAGICA, sizeof(cabecalho.magica));
+    cabecalho.tamanhoCabecalho = sizeof(cabecalhoCheckpoint_t);
+    cabecalho.config = sim->config;
+    cabecalho.indiceTLB = sim->indiceTLB;
+    cabecalho.numQuadrosLivres = sim->numQuadrosLivres;
+    cabecalho.proximoQuadroFIFO = sim->proximoQuadroFIFO;
+    cabecalho.relogio = sim->relogio;
+    cabecalho.referenciasEpoca = sim->referenciasEpoca;
+    cabecalho.referenciasPeriodo = sim->referenciasPeriodo;
+    cabecalho.estatisticas = sim->estatisticas;
+    layoutCheckpoint(sim, &cabecalho);
+
+    int fd = open(caminho, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1)
+    {
+        return -1;
+    }
+    if (ftruncate(fd, (off_t) cabecalho.tamanho) == -1)
+    {
+        close(fd);
+        return -1;
+    }
+
+    char *destino = mmap(0, cabecalho.tamanho, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (destino == MAP_FAILED)
+    {
+        return -1;
+    }
+
+    memcpy(destino, &cabecalho, sizeof(cabecalho));
+    memcpy(destino + cabecalho.offsetTLB, sim->tlb, sizeof(struct entradaTLB) * sim->config.entradasTLB);
+    memcpy(destino + cabecalho.offsetTabela, sim->tabelaPaginas,
+           sizeof(entradaPagina_t) * sim->config.paginas);
+    memcpy(destino + cabecalho.offsetQuadros, sim->paginaDoQuadro, sizeof(int) * sim->totalQuadros);
+    memcpy(destino + cabecalho.offsetQuadros + sizeof(int) * sim->totalQuadros, sim->acessosQuadro,
+           sizeof(unsigned int) * sim->totalQuadros);
+    memcpy(destino + cabecalho.offsetContadores, sim->contadores, sizeof(uint16_t) * sim->numContadores);
+    memcpy(destino + cabecalho.offsetLivres, sim->quadrosLivres, sizeof(uint64_t) * sim->palavrasLivres);
+    memcpy(destino + cabecalho.offsetMemoria, sim->memoriaPrincipal, (size_t) sim->totalQuadros * sim->tamanhoPagina);
+
+    int erro = msync(destino, cabecalho.tamanho, MS_SYNC);
+    munmap(destino, cabecalho.tamanho);
+
+    return erro;
+}
+
+simulador_t *simuladorRestaura(const char *caminho, const char *arquivoBacking)
+{
+    int fd = open(caminho, O_RDONLY);
+    if (fd == -1)
+    {
+        return NULL;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == -1 || (size_t) info.st_size < sizeof(cabecalhoCheckpoint_t))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    // MAP_PRIVATE: a continuação escreve nas suas próprias cópias, o arquivo fica intacto.
+    cabecalhoCheckpoint_t *cabecalho = mmap(0, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (cabecalho == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    simulador_t *sim = NULL;
+    if (memcmp(cabecalho->magica, CHECKPOINT_MAGICA, sizeof(cabecalho->magica)) == 0 &&
+        cabecalho->tamanhoCabecalho == sizeof(cabecalhoCheckpoint_t) &&
+        cabecalho->tamanho == (uint64_t) info.st_size)
+    {
+        sim = alocaSimulador(&cabecalho->config);
+    }
+    if (sim != NULL)
+    {
+        // Os offsets viram ponteiros para dentro do arquivo: só servem os que a configuração produziria.
+        cabecalhoCheckpoint_t esperado;
+        layoutCheckpoint(sim, &esperado);
+        if (cabecalho->offsetTLB != esperado.offsetTLB || cabecalho->offsetTabela != esperado.offsetTabela ||
+            cabecalho->offsetQuadros != esperado.offsetQuadros ||
+            cabecalho->offsetContadores != esperado.offsetContadores ||
+            cabecalho->offsetLivres != esperado.offsetLivres || cabecalho->offsetMemoria != esperado.offsetMemoria ||
+            cabecalho->tamanho != esperado.tamanho)
+        {
+            simuladorDestroi(sim);
+            sim = NULL;
+        }
+    }
+    if (sim == NULL)
+    {
+        munmap(cabecalho, info.st_size);
+        return NULL;
+    }
+
+    char *base = (char *) cabecalho;
+    sim->checkpoint = cabecalho;
+    sim->tlb = (struct entradaTLB *) (base + cabecalho->offsetTLB);
+    sim->tabelaPaginas = (entradaPagina_t *) (base + cabecalho->offsetTabela);
+    sim->memoriaPrincipal = (unsigned char *) (base + cabecalho->offsetMemoria);
+    sim->paginaDoQuadro = (int *) (base + cabecalho->offsetQuadros);
+    sim->acessosQuadro = (unsigned int *) (base + cabecalho->offsetQuadros + sizeof(int) * sim->totalQuadros);
+    sim->contadores = (uint16_t *) (base + cabecalho->offsetContadores);
+    sim->quadrosLivres = (uint64_t *) (base + cabecalho->offsetLivres);
+    sim->referenciasEpoca = cabecalho->referenciasEpoca;
+    sim->referenciasPeriodo = cabecalho->referenciasPeriodo;
+    sim->relogio = cabecalho->relogio;
+    sim->indiceTLB = cabecalho->indiceTLB;
+    sim->numQuadrosLivres = cabecalho->numQuadrosLivres;
+    sim->proximoQuadroFIFO = cabecalho->proximoQuadroFIFO;
+    sim->estatisticas = cabecalho->estatisticas;
+
+    if (abreBacking(sim, arquivoBacking) == -1)
+    {
+        simuladorDestroi(sim);
+        return NULL;
+    }
+
+    return sim;
+}
+
+//==================== Tradução em Lote ====================
+
+void simuladorTraduzLote(simulador_t *sim, const int *enderecos, int n, int *fisicos, unsigned char *valores)
+{
+    simuladorTraduzLoteFlags(sim, enderecos, n, fisicos, valores, NULL);
+}
+
+void simuladorTraduzLoteFlags(simulador_t *sim, const int *enderecos, int n, int *fisicos, unsigned char *valores,
+                              unsigned char *flags)
+{
+    unsigned char valor;
+    unsigned char flag;
+    int i = 0;
+
+    /*
+     Caminho rápido: enquanto houver blocos completos, resolve os acertos na TLB
+     em bloco e só manda para traduz() o primeiro erro. Como um erro altera a TLB,
+     o bloco seguinte começa logo depois dele.
+     */
+    while (sim->config.processamentoBloco && i + BLOCO_TLB <= n)
+    {
+        int paginas[BLOCO_TLB];
+        int deslocamentos[BLOCO_TLB];
+        int quadros[BLOCO_TLB];
+        int j = 0;
+        int migrou = 0;
+
+        buscaTLBBloco(sim, enderecos + i, paginas, deslocamentos, quadros);
+
+        // Uma migração entre camadas muda quadros já procurados e uma operação do trace pode
+        // liberar quadros: o bloco termina ali. Escritas também vão para traduz(), que suja a página.
+        while (j < BLOCO_TLB && quadros[j] != -1 && enderecos[i + j] >= 0 && !migrou)
+        {
+            sim->estatisticas.totalEnderecos++;
+            sim->estatisticas.acertosTLB++;
+            fisicos[i + j] = acessaQuadro(sim, paginas[j], quadros[j], deslocamentos[j], &valor);
+
+            if (valores != NULL)
+            {
+                valores[i + j] = valor;
+            }
+            if (flags != NULL)
+            {
+                flags[i + j] = RESULTADO_ACERTO_TLB;
+            }
+            j++;
+            migrou = avancaEpoca(sim);
+        }
+
+        if (j < BLOCO_TLB && !migrou)
+        {
+            fisicos[i + j] = traduz(sim, enderecos[i + j], &valor, &flag);
+
+            if (valores != NULL)
+            {
+                valores[i + j] = valor;
+            }
+            if (flags != NULL)
+            {
+                flags[i + j] = flag;
+            }
+            j++;
+            avancaEpoca(sim);
+        }
+
+        i += j;
+    }
+
+    for (; i < n; i++)
+    {
+        fisicos[i] = traduz(sim, enderecos[i], &valor, &flag);
+
+        if (valores != NULL)
+        {
+            valores[i] = valor;
+        }
+        if (flags != NULL)
+        {
+            flags[i] = flag;
+        }
+        avancaEpoca(sim);
+    }
+}
+
+void simuladorEstatisticas(const simulador_t *sim, estatisticasSimulador_t *estatisticas)
+{
+    *estatisticas = sim->estatisticas;
+    estatisticas->quadrosEmUso = sim->totalQuadros - sim->numQuadrosLivres;
+    suporteEstatisticas(sim->suporte, &estatisticas->es);
+
+    // O custo dos acessos é calculado aqui para não pesar no caminho de cada referência.
+    estatisticas->custoAcessos = (double) sim->estatisticas.acessosRapidos * sim->config.latenciaRapida +
+                                 (double) sim->estatisticas.acessosLentos * sim->config.latenciaLenta;
+    estatisticas->custoTLB = (double) sim->estatisticas.totalEnderecos * sim->config.latenciaTLB;
+    estatisticas->custoTabela = (double) (sim->estatisticas.totalEnderecos - sim->estatisticas.acertosTLB) *
+                                sim->config.latenciaTabela;
+    estatisticas->custoFaltas = (double) sim->estatisticas.faltasPagina * sim->config.latenciaFalta;
+    estatisticas->custoEscritas = (double) sim->estatisticas.escritasDeVolta * sim->config.latenciaEscrita;
+
+    double total = estatisticas->custoTLB + estatisticas->custoTabela + estatisticas->custoAcessos +
+                   estatisticas->custoFaltas + estatisticas->custoEscritas + estatisticas->custoMigracoes;
+    estatisticas->tempoEfetivoAcesso = sim->estatisticas.totalEnderecos > 0 ? total / sim->estatisticas.totalEnderecos : 0;
+}
+
+const configSimulador_t *simuladorConfig(const simulador_t *sim)
+{
+    return &sim->config;
+}
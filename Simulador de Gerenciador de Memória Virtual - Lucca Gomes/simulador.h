@@ -0,0 +1,151 @@
+/*
+  Biblioteca do Gerenciador de Memória Virtual.
+  Todo o estado da simulação (TLB, tabela de páginas, memória física, estado
+  de substituição e contadores) fica dentro de um simulador_t opaco, de modo
+  que vários simuladores podem coexistir no mesmo processo.
+ */
+
+#ifndef SIMULADOR_H
+#define SIMULADOR_H
+
+#include "suporte.h"
+
+// ==================== Tipos ====================
+
+typedef enum
+{
+    POLITICA_FIFO = 0,
+    POLITICA_LRU = 1,
+    POLITICA_ENVELHECIMENTO = 2, // Aging: contador de 16 bits por quadro, deslocado a cada período.
+    POLITICA_RELOGIO = 3         // Clock (segunda chance) sobre o bit de referência da tabela de páginas.
+} politica_t;
+
+typedef struct
+{
+    int bitsDeslocamento;        // Tamanho da página = 1 << bitsDeslocamento.
+    int paginas;                 // Entradas na tabela de páginas.
+    int quadros;                 // Quadros na memória física (camada rápida).
+    int entradasTLB;             // Entradas na TLB.
+    politica_t politica;         // Política de substituição de páginas.
+    int periodoEnvelhecimento;   // Referências entre dois deslocamentos dos contadores (envelhecimento).
+    int processamentoBloco;      // Se 1, resolve acertos na TLB em blocos vetorizados.
+    const char *arquivoBacking;  // Caminho do BACKING_STORE.
+    motorES_t motorES;           // Como as páginas são lidas do BACKING_STORE.
+    int paginasCacheES;          // Páginas no cache do MOTOR_CACHE.
+
+    /*
+     Memória em duas camadas: os quadros [0, quadros) são a camada rápida (DRAM) e
+     os quadros [quadros, quadros + quadrosLentos) a camada lenta (CXL, PMEM).
+     A cada epocaMigracao referências as páginas lentas mais acessadas trocam de
+     lugar com as páginas rápidas menos acessadas.
+     */
+    int quadrosLentos;           // 0 desliga a camada lenta.
+    int latenciaRapida;          // ns por acesso à camada rápida.
+    int latenciaLenta;           // ns por acesso à camada lenta.
+    int custoMigracao;           // ns para copiar uma página de uma camada para a outra.
+    int epocaMigracao;           // Referências entre duas rodadas de migração.
+    int limiarPromocao;          // Acessos na época para uma página lenta ser promovida.
+    int maxMigracoesEpoca;       // Trocas por rodada de migração.
+
+    /*
+     Modelo de custo (ns). O acesso à memória usa latenciaRapida/latenciaLenta.
+     Uma página escrita (E no trace) fica suja e é gravada de volta no
+     BACKING_STORE quando for substituída.
+     */
+    int latenciaTLB;             // Consulta à TLB, em toda referência.
+    int latenciaTabela;          // Percurso da tabela de páginas, em toda falta na TLB.
+    int latenciaFalta;           // Atendimento de uma falta de página (leitura do disco).
+    int latenciaEscrita;         // Gravação de volta de uma página suja substituída.
+} configSimulador_t;
+
+typedef struct
+{
+    long totalEnderecos;
+    long acertosTLB;
+    long faltasPagina;
+    long substituicoes;          // Faltas que tiraram outra página da memória.
+    long escritas;               // Referências de escrita, que também contam em totalEnderecos.
+    long escritasDeVolta;        // Páginas sujas substituídas.
+
+    // Operações do trace (unmap e madvise), que não contam em totalEnderecos.
+    long operacoes;
+    long operacoesUnmap;
+    long operacoesDontneed;
+    long operacoesWillneed;
+    long quadrosLiberados;
+    long faltasAposLiberacao;    // Faltas em páginas cujo quadro foi liberado por unmap/DONTNEED.
+    long preCarregamentos;       // Páginas carregadas por WILLNEED.
+    long preCarregamentosUsados; // Páginas pré-carregadas acessadas depois: faltas evitadas.
+    long quadrosEmUso;
+    long picoQuadrosEmUso;
+
+    // Memória em camadas.
+    long acessosRapidos;
+    long acessosLentos;
+    long promocoes;
+    long rebaixamentos;
+    long bytesMigrados;
+    double custoAcessos;         // ns gastos nos acessos às duas camadas.
+    double custoMigracoes;       // ns gastos copiando páginas entre camadas.
+
+    // Modelo de custo: somando com custoAcessos e custoMigracoes dá o tempo total modelado.
+    double custoTLB;
+    double custoTabela;
+    double custoFaltas;
+    double custoEscritas;
+    double tempoEfetivoAcesso;   // Tempo total modelado / totalEnderecos.
+
+    // E/S do BACKING_STORE desde a criação (ou restauração) do simulador.
+    estatisticasSuporte_t es;
+} estatisticasSimulador_t;
+
+typedef struct simulador simulador_t;
+
+// Flags de cada referência traduzida.
+#define RESULTADO_ACERTO_TLB 1
+#define RESULTADO_FALTA_PAGINA 2
+#define RESULTADO_OPERACAO 4     // Operação do trace (trace.h); o endereço físico é -1.
+#define RESULTADO_ESCRITA 8      // Referência de escrita, que deixou a página suja.
+
+// ==================== Funções ====================
+
+/* Preenche a configuração com a geometria original do virtualManager.c. */
+void simuladorConfigPadrao(configSimulador_t *config);
+
+/* Cria um simulador a partir da configuração. Retorna NULL em caso de erro. */
+simulador_t *simuladorCria(const configSimulador_t *config);
+
+void simuladorDestroi(simulador_t *sim);
+
+/*
+ Traduz n endereços lógicos de uma vez.
+ fisicos[i] e valores[i] recebem o endereço físico e o byte lido de enderecos[i].
+ valores pode ser NULL quando o chamador só precisa dos endereços.
+ Valores negativos em enderecos são escritas ou operações (traceOperacao); as operações
+ recebem fisicos[i] = -1.
+ */
+void simuladorTraduzLote(simulador_t *sim, const int *enderecos, int n, int *fisicos, unsigned char *valores);
+
+/* Como simuladorTraduzLote, e flags[i] recebe os RESULTADO_* de enderecos[i]. */
+void simuladorTraduzLoteFlags(simulador_t *sim, const int *enderecos, int n, int *fisicos, unsigned char *valores,
+                              unsigned char *flags);
+
+/*
+ Grava todo o estado do simulador (TLB, tabela de páginas, memória física, estado de
+ substituição e contadores) em caminho. totalEnderecos + operacoes é a posição do
+ trace em que a simulação deve continuar. Retorna 0 ou -1.
+ */
+int simuladorSalva(const simulador_t *sim, const char *caminho);
+
+/*
+ Cria um simulador a partir de um checkpoint gravado por simuladorSalva.
+ O arquivo é mapeado com mmap (cópia na escrita) e não é alterado pela continuação.
+ */
+simulador_t *simuladorRestaura(const char *caminho, const char *arquivoBacking);
+
+void simuladorEstatisticas(const simulador_t *sim, estatisticasSimulador_t *estatisticas);
+
+/* Configuração em uso (a de um checkpoint restaurado vem do arquivo). arquivoBacking é NULL. */
+const configSimulador_t *simuladorConfig(const simulador_t *sim);
+
+#endif
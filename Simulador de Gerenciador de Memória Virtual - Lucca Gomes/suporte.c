@@ -0,0 +1,407 @@
+#define _GNU_SOURCE // O_DIRECT
+
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "suporte.h"
+
+#define ALINHAMENTO_DIRETO 4096 // Cobre o tamanho de bloco lógico dos discos comuns.
+
+//==================== Structs ====================
+
+struct suporte
+{
+    motorES_t motor;
+    int (*carrega)(suporte_t *suporte, int pagina, unsigned char *destino);
+
+    int descritor;
+    int tamanhoPagina;
+    int paginas;
+    off_t tamanhoArquivo;
+
+    // MOTOR_MMAP
+    unsigned char *mapeado;
+    size_t tamanhoMapeado;
+
+    // MOTOR_DIRETO
+    unsigned char *bufferAlinhado;
+    size_t tamanhoBufferAlinhado;
+
+    // MOTOR_CACHE: lista LRU duplamente encadeada em vetores, do mais para o menos recente.
+    int paginasCache;
+    int slotsUsados;
+    unsigned char *dadosCache;
+    int *paginaDoSlot;
+    int *slotDaPagina;           // -1 se a página não está no cache.
+    int *anterior;
+    int *proximo;
+    int maisRecente;
+    int menosRecente;
+
+    estatisticasSuporte_t estatisticas;
+};
+
+static const char *nomesMotores[] = {"mmap", "pread", "direto", "cache"};
+
+//==================== Leitura ====================
+
+/* pread até completar n bytes ou chegar ao fim do arquivo. Retorna os bytes lidos ou -1. */
+static ssize_t leituraCompleta(int descritor, unsigned char *destino, size_t n, off_t posicao)
+{
+    size_t lidos = 0;
+
+    while (lidos < n)
+    {
+        ssize_t r = pread(descritor, destino + lidos, n - lidos, posicao + (off_t) lidos);
+        if (r == -1)
+        {
+            return -1;
+        }
+        if (r == 0)
+        {
+            break;
+        }
+        lidos += (size_t) r;
+    }
+
+    return (ssize_t) lidos;
+}
+
+/* Lê uma página com pread e zera o que passar do fim do arquivo. */
+static int lePagina(suporte_t *suporte, int pagina, unsigned char *destino)
+{
+    ssize_t lidos = leituraCompleta(suporte->descritor, destino, suporte->tamanhoPagina,
+                                    (off_t) pagina * suporte->tamanhoPagina);
+    if (lidos == -1)
+    {
+        return -1;
+    }
+
+    memset(destino + lidos, 0, suporte->tamanhoPagina - lidos);
+    suporte->estatisticas.leituras++;
+    suporte->estatisticas.bytesLidos += lidos;
+
+    return 0;
+}
+
+//==================== Motores ====================
+
+static int carregaMmap(suporte_t *suporte, int pagina, unsigned char *destino)
+{
+    size_t inicio = (size_t) pagina * suporte->tamanhoPagina;
+    size_t disponivel = 0;
+
+    if (inicio < suporte->tamanhoMapeado)
+    {
+        disponivel = suporte->tamanhoMapeado - inicio;
+        if (disponivel > (size_t) suporte->tamanhoPagina)
+        {
+            disponivel = suporte->tamanhoPagina;
+        }
+        memcpy(destino, suporte->mapeado + inicio, disponivel);
+    }
+    memset(destino + disponivel, 0, suporte->tamanhoPagina - disponivel);
+
+    suporte->estatisticas.leituras++;
+    suporte->estatisticas.bytesLidos += (long) disponivel;
+
+    return 0;
+}
+
+static int carregaPread(suporte_t *suporte, int pagina, unsigned char *destino)
+{
+    return lePagina(suporte, pagina, destino);
+}
+
+/* O_DIRECT exige posição, tamanho e buffer alinhados: lê os blocos que contêm a página. */
+static int carregaDireto(suporte_t *suporte, int pagina, unsigned char *destino)
+{
+    off_t posicao = (off_t) pagina * suporte->tamanhoPagina;
+    off_t inicio = posicao & ~(off_t) (ALINHAMENTO_DIRETO - 1);
+    off_t fim = (posicao + suporte->tamanhoPagina + ALINHAMENTO_DIRETO - 1) & ~(off_t) (ALINHAMENTO_DIRETO - 1);
+
+    ssize_t lidos = leituraCompleta(suporte->descritor, suporte->bufferAlinhado, (size_t) (fim - inicio), inicio);
+    if (lidos == -1)
+    {
+        return -1;
+    }
+
+    ssize_t disponivel = lidos - (ssize_t) (posicao - inicio);
+    if (disponivel < 0)
+    {
+        disponivel = 0;
+    }
+    if (disponivel > suporte->tamanhoPagina)
+    {
+        disponivel = suporte->tamanhoPagina;
+    }
+    memcpy(destino, suporte->bufferAlinhado + (posicao - inicio), disponivel);
+    memset(destino + disponivel, 0, suporte->tamanhoPagina - disponivel);
+
+    suporte->estatisticas.leituras++;
+    suporte->estatisticas.bytesLidos += lidos;
+
+    return 0;
+}
+
+static void cacheDesliga(suporte_t *suporte, int slot)
+{
+    int anterior = suporte->anterior[slot];
+    int proximo = suporte->proximo[slot];
+
+    if (anterior != -1)
+    {
+        suporte->proximo[anterior] = proximo;
+    }
+    else
+    {
+        suporte->maisRecente = proximo;
+    }
+
+    if (proximo != -1)
+    {
+        suporte->anterior[proximo] = anterior;
+    }
+    else
+    {
+        suporte->menosRecente = anterior;
+    }
+}
+
+static void cacheColocaNaFrente(suporte_t *suporte, int slot)
+{
+    suporte->anterior[slot] = -1;
+    suporte->proximo[slot] = suporte->maisRecente;
+    if (suporte->maisRecente != -1)
+    {
+        suporte->anterior[suporte->maisRecente] = slot;
+    }
+    suporte->maisRecente = slot;
+    if (suporte->menosRecente == -1)
+    {
+        suporte->menosRecente = slot;
+    }
+}
+
+static int carregaCache(suporte_t *suporte, int pagina, unsigned char *destino)
+{
+    int slot = suporte->slotDaPagina[pagina];
+
+    if (slot != -1)
+    {
+        suporte->estatisticas.acertosCache++;
+        cacheDesliga(suporte, slot);
+    }
+    else
+    {
+        suporte->estatisticas.faltasCache++;
+
+        if (suporte->slotsUsados < suporte->paginasCache)
+        {
+            slot = suporte->slotsUsados++;
+        }
+        else
+        {
+            slot = suporte->menosRecente;
+            cacheDesliga(suporte, slot);
+            // Um slot cuja leitura falhou não guarda página nenhuma.
+            if (suporte->paginaDoSlot[slot] != -1)
+            {
+                suporte->slotDaPagina[suporte->paginaDoSlot[slot]] = -1;
+            }
+        }
+
+        if (lePagina(suporte, pagina, suporte->dadosCache + (size_t) slot * suporte->tamanhoPagina) == -1)
+        {
+            // O slot volta a ficar livre no fim da lista.
+            suporte->paginaDoSlot[slot] = -1;
+            suporte->anterior[slot] = suporte->menosRecente;
+            suporte->proximo[slot] = -1;
+            if (suporte->menosRecente != -1)
+            {
+                suporte->proximo[suporte->menosRecente] = slot;
+            }
+            else
+            {
+                suporte->maisRecente = slot;
+            }
+            suporte->menosRecente = slot;
+            return -1;
+        }
+
+        suporte->paginaDoSlot[slot] = pagina;
+        suporte->slotDaPagina[pagina] = slot;
+    }
+
+    cacheColocaNaFrente(suporte, slot);
+    memcpy(destino, suporte->dadosCache + (size_t) slot * suporte->tamanhoPagina, suporte->tamanhoPagina);
+
+    return 0;
+}
+
+//==================== Interface ====================
+
+int suporteMotorPorNome(const char *nome)
+{
+    for (int i = 0; i < (int) (sizeof(nomesMotores) / sizeof(nomesMotores[0])); i++)
+    {
+        if (strcmp(nome, nomesMotores[i]) == 0)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+const char *suporteNomeMotor(motorES_t motor)
+{
+    return motor >= MOTOR_MMAP && motor <= MOTOR_CACHE ? nomesMotores[motor] : "?";
+}
+
+static int preparaCache(suporte_t *suporte, int paginasCache)
+{
+    suporte->paginasCache = paginasCache > 0 ? paginasCache : 1;
+    suporte->maisRecente = -1;
+    suporte->menosRecente = -1;
+    suporte->dadosCache = malloc((size_t) suporte->paginasCache * suporte->tamanhoPagina);
+    suporte->paginaDoSlot = malloc(sizeof(int) * suporte->paginasCache);
+    suporte->anterior = malloc(sizeof(int) * suporte->paginasCache);
+    suporte->proximo = malloc(sizeof(int) * suporte->paginasCache);
+    suporte->slotDaPagina = malloc(sizeof(int) * suporte->paginas);
+    if (suporte->dadosCache == NULL || suporte->paginaDoSlot == NULL || suporte->anterior == NULL ||
+        suporte->proximo == NULL || suporte->slotDaPagina == NULL)
+    {
+        return -1;
+    }
+
+    for (int i = 0; i < suporte->paginas; i++)
+    {
+        suporte->slotDaPagina[i] = -1;
+    }
+
+    return 0;
+}
+
+suporte_t *suporteAbre(const char *caminho, motorES_t motor, int tamanhoPagina, int paginas, int paginasCache)
+{
+    if (motor < MOTOR_MMAP || motor > MOTOR_CACHE || tamanhoPagina <= 0 || paginas <= 0)
+    {
+        return NULL;
+    }
+
+    suporte_t *suporte = calloc(1, sizeof(suporte_t));
+    if (suporte == NULL)
+    {
+        return NULL;
+    }
+
+    suporte->motor = motor;
+    suporte->tamanhoPagina = tamanhoPagina;
+    suporte->paginas = paginas;
+    suporte->mapeado = MAP_FAILED;
+    suporte->descritor = open(caminho, motor == MOTOR_DIRETO ? O_RDONLY | O_DIRECT : O_RDONLY);
+
+    struct stat info;
+    if (suporte->descritor == -1 || fstat(suporte->descritor, &info) == -1)
+    {
+        suporteFecha(suporte);
+        return NULL;
+    }
+    suporte->tamanhoArquivo = info.st_size;
+
+    int erro = 0;
+    switch (motor)
+    {
+        case MOTOR_MMAP:
+            // Só a parte que existe no arquivo é mapeada: acessar além do fim daria SIGBUS.
+            suporte->carrega = carregaMmap;
+            suporte->tamanhoMapeado = (size_t) paginas * tamanhoPagina;
+            if ((off_t) suporte->tamanhoMapeado > info.st_size)
+            {
+                suporte->tamanhoMapeado = (size_t) info.st_size;
+            }
+            if (suporte->tamanhoMapeado > 0)
+            {
+                suporte->mapeado = mmap(0, suporte->tamanhoMapeado, PROT_READ, MAP_PRIVATE, suporte->descritor, 0);
+                erro = suporte->mapeado == MAP_FAILED;
+            }
+            break;
+
+        case MOTOR_PREAD:
+            suporte->carrega = carregaPread;
+            break;
+
+        case MOTOR_DIRETO:
+            suporte->carrega = carregaDireto;
+            suporte->tamanhoBufferAlinhado =
+                ((size_t) tamanhoPagina + ALINHAMENTO_DIRETO - 1) / ALINHAMENTO_DIRETO * ALINHAMENTO_DIRETO +
+                ALINHAMENTO_DIRETO;
+            erro = posix_memalign((void **) &suporte->bufferAlinhado, ALINHAMENTO_DIRETO,
+                                  suporte->tamanhoBufferAlinhado) != 0;
+            break;
+
+        case MOTOR_CACHE:
+            suporte->carrega = carregaCache;
+            erro = preparaCache(suporte, paginasCache) == -1;
+            break;
+    }
+
+    if (erro)
+    {
+        suporteFecha(suporte);
+        return NULL;
+    }
+
+    return suporte;
+}
+
+int suporteCarrega(suporte_t *suporte, int pagina, unsigned char *destino)
+{
+    struct timespec inicio, fim;
+
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    int resultado = suporte->carrega(suporte, pagina, destino);
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+
+    suporte->estatisticas.segundos += (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) * 1e-9;
+
+    return resultado;
+}
+
+void suporteEstatisticas(const suporte_t *suporte, estatisticasSuporte_t *estatisticas)
+{
+    *estatisticas = suporte->estatisticas;
+}
+
+void suporteFecha(suporte_t *suporte)
+{
+    if (suporte == NULL)
+    {
+        return;
+    }
+
+    if (suporte->mapeado != MAP_FAILED)
+    {
+        munmap(suporte->mapeado, suporte->tamanhoMapeado);
+    }
+    if (suporte->descritor != -1)
+    {
+        close(suporte->descritor);
+    }
+
+    free(suporte->bufferAlinhado);
+    free(suporte->dadosCache);
+    free(suporte->paginaDoSlot);
+    free(suporte->slotDaPagina);
+    free(suporte->anterior);
+    free(suporte->proximo);
+    free(suporte);
+}
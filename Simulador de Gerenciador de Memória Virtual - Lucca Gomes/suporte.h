@@ -0,0 +1,50 @@
+/*
+  Leitura de páginas do BACKING_STORE.
+  O carregamento de uma página fica atrás de um motor de E/S, escolhido na abertura:
+  mmap do arquivo inteiro, pread com buffer do kernel, O_DIRECT com buffers alinhados
+  ou pread através de um cache LRU de páginas no espaço do usuário.
+  Cada motor mede o tempo real gasto e os bytes lidos do arquivo.
+ */
+
+#ifndef SUPORTE_H
+#define SUPORTE_H
+
+typedef enum
+{
+    MOTOR_MMAP = 0,
+    MOTOR_PREAD = 1,
+    MOTOR_DIRETO = 2,            // O_DIRECT, sem passar pelo cache de páginas do kernel.
+    MOTOR_CACHE = 3              // pread com cache LRU próprio.
+} motorES_t;
+
+typedef struct
+{
+    long leituras;               // Chamadas ao arquivo (pread) ou cópias do mapeamento (mmap).
+    long bytesLidos;             // Bytes pedidos ao arquivo; com O_DIRECT inclui o alinhamento.
+    double segundos;             // Tempo real dentro do motor, incluindo as faltas do mmap.
+    long acertosCache;
+    long faltasCache;
+} estatisticasSuporte_t;
+
+typedef struct suporte suporte_t;
+
+/* Converte "mmap", "pread", "direto" ou "cache". Retorna -1 se o nome não existe. */
+int suporteMotorPorNome(const char *nome);
+
+const char *suporteNomeMotor(motorES_t motor);
+
+/*
+ Abre o arquivo com paginas páginas de tamanhoPagina bytes.
+ paginasCache só é usado por MOTOR_CACHE. Retorna NULL em caso de erro
+ (por exemplo, O_DIRECT em um sistema de arquivos que não o aceita).
+ */
+suporte_t *suporteAbre(const char *caminho, motorES_t motor, int tamanhoPagina, int paginas, int paginasCache);
+
+/* Copia a página para destino. Bytes além do fim do arquivo são zerados. Retorna 0 ou -1. */
+int suporteCarrega(suporte_t *suporte, int pagina, unsigned char *destino);
+
+void suporteEstatisticas(const suporte_t *suporte, estatisticasSuporte_t *estatisticas);
+
+void suporteFecha(suporte_t *suporte);
+
+#endif
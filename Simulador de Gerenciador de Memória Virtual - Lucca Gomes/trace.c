@@ -0,0 +1,665 @@
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "trace.h"
+
+#define MAX_THREADS 64
+#define DIGITOS_SWAR 8 // Dígitos convertidos de uma vez em um inteiro de 64 bits.
+#define TAMANHO_BLOCO_TEXTO (1 << 20) // Bytes de texto em memória no leitor em blocos.
+
+//==================== Structs ====================
+
+typedef struct
+{
+    const char *inicio;     // Primeiro byte do pedaço (início de linha).
+    const char *fim;        // Um byte depois do pedaço (início de linha ou fim do texto).
+    const char *fimTexto;   // Fim do texto inteiro, limite para leituras de 8 bytes.
+    int *destino;           // Onde os endereços do pedaço são escritos.
+    long quantidade;        // Linhas contadas (fase 1) ou endereços escritos (fase 2).
+} pedacoTrace_t;
+
+struct leitorTrace
+{
+    int fd;
+    long restantes;         // Binário: endereços ainda não lidos.
+    int texto;              // Se 1, o arquivo é texto e passa por buffer.
+    char *buffer;           // Texto: TAMANHO_BLOCO_TEXTO bytes lidos do arquivo.
+    size_t inicio;          // Primeiro byte ainda não convertido.
+    size_t fim;             // Um byte depois do último lido.
+    int fimArquivo;
+};
+
+//==================== Conversão de Decimais ====================
+
+/*
+ Converte até DIGITOS_SWAR dígitos de uma vez (SWAR: SIMD dentro de um registrador).
+ Lê 8 bytes a partir de p, descarta os que passam de tamanho e completa com zeros à esquerda.
+ Retorna -1 se algum dos bytes da linha não for um dígito.
+ */
+static long converteSWAR(const char *p, int tamanho)
+{
+    uint64_t valor;
+    memcpy(&valor, p, sizeof(valor));
+
+    // Cada byte vira 0..9 se for um dígito; os bytes depois da linha saem pelo shift.
+    valor = (valor ^ 0x3030303030303030ULL) << (8 * (DIGITOS_SWAR - tamanho));
+
+    if (((valor | (valor + 0x0606060606060606ULL)) & 0xF0F0F0F0F0F0F0F0ULL) != 0)
+    {
+        return -1;
+    }
+
+    // Junta os dígitos dois a dois, depois quatro a quatro, depois oito.
+    valor = ((valor * ((10ULL << 8) + 1)) >> 8) & 0x00FF00FF00FF00FFULL;
+    valor = ((valor * ((100ULL << 16) + 1)) >> 16) & 0x0000FFFF0000FFFFULL;
+    valor = (valor * ((10000ULL << 32) + 1)) >> 32;
+
+    return (long) valor;
+}
+
+/*
+ Conversão byte a byte, com a mesma semântica de atoi para números sem sinal.
+ Uma linha que começa com U, D ou W é uma operação e uma com E é uma escrita (traceOperacao).
+ */
+static int converteEscalar(const char *p, const char *fim)
+{
+    unsigned int valor = 0;
+    int operacao = -1;
+
+    while (p < fim && (*p == ' ' || *p == '\t'))
+    {
+        p++;
+    }
+    if (p < fim)
+    {
+        switch (*p)
+        {
+            case 'U': case 'u': operacao = TRACE_OPERACAO_UNMAP; break;
+            case 'D': case 'd': operacao = TRACE_OPERACAO_DONTNEED; break;
+            case 'W': case 'w': operacao = TRACE_OPERACAO_WILLNEED; break;
+            case 'E': case 'e': operacao = TRACE_ESCRITA; break;
+        }
+    }
+    if (operacao != -1)
+    {
+        p++;
+        while (p < fim && (*p == ' ' || *p == '\t'))
+        {
+            p++;
+        }
+    }
+    while (p < fim && *p >= '0' && *p <= '9')
+    {
+        valor = valor * 10 + (unsigned int) (*p - '0');
+        p++;
+    }
+
+    return operacao != -1 ? traceOperacao(operacao, (int) valor) : (int) valor;
+}
+
+/*
+ Converte uma linha de tamanho bytes, sem a quebra. fimTexto limita as leituras de
+ 8 bytes do SWAR. Retorna 0 se a linha está vazia e não gera endereço.
+ */
+static int converteLinha(const char *p, int tamanho, const char *fimTexto, int *endereco)
+{
+    if (tamanho > 0 && p[tamanho - 1] == '\r')
+    {
+        tamanho--;
+    }
+    if (tamanho == 0)
+    {
+        return 0;
+    }
+
+    long valor = -1;
+
+    if (tamanho <= DIGITOS_SWAR && p + DIGITOS_SWAR <= fimTexto)
+    {
+        valor = converteSWAR(p, tamanho);
+    }
+    if (valor < 0)
+    {
+        valor = converteEscalar(p, p + tamanho);
+    }
+    *endereco = (int) valor;
+
+    return 1;
+}
+
+//==================== Threads ====================
+
+/* Fase 1: conta as linhas do pedaço para saber onde cada thread escreve. */
+static void *contaLinhas(void *arg)
+{
+    pedacoTrace_t *pedaco = arg;
+    const char *p = pedaco->inicio;
+    long linhas = 0;
+
+    while (p < pedaco->fim)
+    {
+        const char *quebra = memchr(p, '\n', pedaco->fim - p);
+
+        linhas++;
+        if (quebra == NULL)
+        {
+            break;
+        }
+        p = quebra + 1;
+    }
+
+    pedaco->quantidade = linhas;
+
+    return NULL;
+}
+
+/* Fase 2: converte as linhas do pedaço para pedaco->destino. */
+static void *convertePedaco(void *arg)
+{
+    pedacoTrace_t *pedaco = arg;
+    const char *p = pedaco->inicio;
+    int *destino = pedaco->destino;
+
+    while (p < pedaco->fim)
+    {
+        const char *quebra = memchr(p, '\n', pedaco->fim - p);
+        const char *fimLinha = quebra != NULL ? quebra : pedaco->fim;
+
+        destino += converteLinha(p, (int) (fimLinha - p), pedaco->fimTexto, destino);
+        p = fimLinha + 1;
+    }
+
+    pedaco->quantidade = destino - pedaco->destino;
+
+    return NULL;
+}
+
+/* Executa funcao em uma thread por pedaço. */
+static void executaPedacos(void *(*funcao)(void *), pedacoTrace_t *pedacos, int numPedacos)
+{
+    pthread_t threads[MAX_THREADS];
+
+    if (numPedacos == 0)
+    {
+        return;
+    }
+
+    for (int i = 1; i < numPedacos; i++)
+    {
+        pthread_create(&threads[i], NULL, funcao, &pedacos[i]);
+    }
+    funcao(&pedacos[0]);
+    for (int i = 1; i < numPedacos; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+//==================== Leitura do Texto ====================
+
+int traceThreadsPadrao(void)
+{
+    long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return nucleos > 0 ? (int) nucleos : 1;
+}
+
+/* Tamanho em bytes de um trace binário com quantidade endereços. */
+static size_t tamanhoBinario(long quantidade)
+{
+    return sizeof(cabecalhoTrace_t) + (size_t) quantidade * sizeof(int);
+}
+
+/*
+ Lê o trace em texto de caminho e escreve o resultado no formato binário.
+ Se fdSaida for -1, o destino é memória anônima; senão, o arquivo fdSaida.
+ Devolve o cabeçalho mapeado (já com quantidade preenchida) ou NULL.
+ */
+static cabecalhoTrace_t *leTexto(const char *caminho, int numThreads, int fdSaida)
+{
+    int fd = open(caminho, O_RDONLY);
+    if (fd == -1)
+    {
+        return NULL;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == -1)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    size_t tamanho = (size_t) info.st_size;
+    const char *texto = "";
+    if (tamanho > 0)
+    {
+        texto = mmap(0, tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (texto == MAP_FAILED)
+        {
+            close(fd);
+            return NULL;
+        }
+        madvise((void *) texto, tamanho, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    if (numThreads <= 0)
+    {
+        numThreads = traceThreadsPadrao();
+    }
+    if (numThreads > MAX_THREADS)
+    {
+        numThreads = MAX_THREADS;
+    }
+
+    // Divide o texto em pedaços, cada um começando logo após uma quebra de linha.
+    pedacoTrace_t pedacos[MAX_THREADS];
+    const char *fimTexto = texto + tamanho;
+    const char *inicio = texto;
+    int numPedacos = 0;
+
+    for (int i = 0; i < numThreads && inicio < fimTexto; i++)
+    {
+        const char *fim = i == numThreads - 1 ? fimTexto : texto + tamanho / numThreads * (i + 1);
+
+        if (fim < inicio)
+        {
+            fim = inicio;
+        }
+        if (fim < fimTexto)
+        {
+            const char *quebra = memchr(fim, '\n', fimTexto - fim);
+            fim = quebra != NULL ? quebra + 1 : fimTexto;
+        }
+
+        pedacos[numPedacos].inicio = inicio;
+        pedacos[numPedacos].fim = fim;
+        pedacos[numPedacos].fimTexto = fimTexto;
+        numPedacos++;
+        inicio = fim;
+    }
+
+    executaPedacos(contaLinhas, pedacos, numPedacos);
+
+    long maximo = 0;
+    for (int i = 0; i < numPedacos; i++)
+    {
+        maximo += pedacos[i].quantidade;
+    }
+
+    // O destino já tem o layout do arquivo binário: cabeçalho + endereços.
+    size_t tamanhoDestino = tamanhoBinario(maximo);
+    cabecalhoTrace_t *cabecalho;
+
+    if (fdSaida == -1)
+    {
+        cabecalho = mmap(0, tamanhoDestino, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    else if (ftruncate(fdSaida, (off_t) tamanhoDestino) == 0)
+    {
+        cabecalho = mmap(0, tamanhoDestino, PROT_READ | PROT_WRITE, MAP_SHARED, fdSaida, 0);
+    }
+    else
+    {
+        cabecalho = MAP_FAILED;
+    }
+
+    if (cabecalho == MAP_FAILED)
+    {
+        if (tamanho > 0)
+        {
+            munmap((void *) texto, tamanho);
+        }
+        return NULL;
+    }
+
+    int *enderecos = (int *) (cabecalho + 1);
+    long deslocamento = 0;
+    for (int i = 0; i < numPedacos; i++)
+    {
+        pedacos[i].destino = enderecos + deslocamento;
+        deslocamento += pedacos[i].quantidade;
+    }
+
+    executaPedacos(convertePedaco, pedacos, numPedacos);
+
+    // Linhas vazias não geram endereço: junta os pedaços para tirar os buracos.
+    long quantidade = 0;
+    for (int i = 0; i < numPedacos; i++)
+    {
+        if (pedacos[i].destino != enderecos + quantidade)
+        {
+            memmove(enderecos + quantidade, pedacos[i].destino, pedacos[i].quantidade * sizeof(int));
+        }
+        quantidade += pedacos[i].quantidade;
+    }
+
+    memcpy(cabecalho->magica, TRACE_MAGICA, sizeof(cabecalho->magica));
+    cabecalho->reservado = 0;
+    cabecalho->quantidade = quantidade;
+
+    if (tamanho > 0)
+    {
+        munmap((void *) texto, tamanho);
+    }
+
+    // Devolve ao sistema as páginas que sobraram por causa das linhas vazias.
+    size_t tamanhoPagina = (size_t) sysconf(_SC_PAGESIZE);
+    size_t usado = (tamanhoBinario(quantidade) + tamanhoPagina - 1) / tamanhoPagina * tamanhoPagina;
+    size_t mapeado = (tamanhoDestino + tamanhoPagina - 1) / tamanhoPagina * tamanhoPagina;
+    if (usado < mapeado)
+    {
+        munmap((char *) cabecalho + usado, mapeado - usado);
+    }
+
+    return cabecalho;
+}
+
+//==================== API ====================
+
+int *traceLeTexto(const char *caminho, int numThreads, long *quantidade)
+{
+    cabecalhoTrace_t *cabecalho = leTexto(caminho, numThreads, -1);
+    if (cabecalho == NULL)
+    {
+        return NULL;
+    }
+
+    *quantidade = cabecalho->quantidade;
+
+    return (int *) (cabecalho + 1);
+}
+
+long traceConverteTexto(const char *entrada, const char *saida, int numThreads)
+{
+    int fdSaida = open(saida, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fdSaida == -1)
+    {
+        return -1;
+    }
+
+    cabecalhoTrace_t *cabecalho = leTexto(entrada, numThreads, fdSaida);
+    if (cabecalho == NULL)
+    {
+        close(fdSaida);
+        return -1;
+    }
+
+    long quantidade = cabecalho->quantidade;
+    munmap(cabecalho, tamanhoBinario(quantidade));
+
+    // Corta o espaço reservado para as linhas vazias.
+    int erro = ftruncate(fdSaida, (off_t) tamanhoBinario(quantidade));
+    close(fdSaida);
+
+    return erro == 0 ? quantidade : -1;
+}
+
+const int *traceCarrega(const char *caminho, int numThreads, long *quantidade)
+{
+    int fd = open(caminho, O_RDONLY);
+    if (fd == -1)
+    {
+        return NULL;
+    }
+
+    cabecalhoTrace_t cabecalho;
+    struct stat info;
+    ssize_t lidos = read(fd, &cabecalho, sizeof(cabecalho));
+
+    if (lidos != (ssize_t) sizeof(cabecalho) || memcmp(cabecalho.magica, TRACE_MAGICA, sizeof(cabecalho.magica)) != 0)
+    {
+        // Não é binário: lê como texto.
+        close(fd);
+        return traceLeTexto(caminho, numThreads, quantidade);
+    }
+
+    if (fstat(fd, &info) == -1 || cabecalho.quantidade < 0 ||
+        (size_t) info.st_size < tamanhoBinario((long) cabecalho.quantidade))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    cabecalhoTrace_t *mapeado = mmap(0, tamanhoBinario((long) cabecalho.quantidade), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapeado == MAP_FAILED)
+    {
+        return NULL;
+    }
+    madvise(mapeado, tamanhoBinario((long) cabecalho.quantidade), MADV_SEQUENTIAL);
+
+    *quantidade = (long) cabecalho.quantidade;
+
+    return (const int *) (mapeado + 1);
+}
+
+void traceLibera(const int *enderecos, long quantidade)
+{
+    // Tanto o trace binário quanto o lido do texto estão mapeados logo depois de um cabeçalho.
+    if (enderecos != NULL)
+    {
+        munmap((cabecalhoTrace_t *) enderecos - 1, tamanhoBinario(quantidade));
+    }
+}
+
+//==================== Leitura em Blocos ====================
+
+leitorTrace_t *traceAbre(const char *caminho)
+{
+    leitorTrace_t *leitor = calloc(1, sizeof(leitorTrace_t));
+    if (leitor == NULL)
+    {
+        return NULL;
+    }
+
+    leitor->fd = open(caminho, O_RDONLY);
+    if (leitor->fd == -1)
+    {
+        free(leitor);
+        return NULL;
+    }
+    posix_fadvise(leitor->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    cabecalhoTrace_t cabecalho;
+    ssize_t lidos = read(leitor->fd, &cabecalho, sizeof(cabecalho));
+
+    if (lidos == (ssize_t) sizeof(cabecalho) && memcmp(cabecalho.magica, TRACE_MAGICA, sizeof(cabecalho.magica)) == 0)
+    {
+        if (cabecalho.quantidade < 0)
+        {
+            traceFecha(leitor);
+            return NULL;
+        }
+        leitor->restantes = (long) cabecalho.quantidade;
+
+        return leitor;
+    }
+
+    // Não é binário: o que já foi lido é o começo do texto.
+    leitor->texto = 1;
+    leitor->buffer = malloc(TAMANHO_BLOCO_TEXTO);
+    if (lidos < 0 || leitor->buffer == NULL)
+    {
+        traceFecha(leitor);
+        return NULL;
+    }
+    memcpy(leitor->buffer, &cabecalho, (size_t) lidos);
+    leitor->fim = (size_t) lidos;
+
+    return leitor;
+}
+
+/* Binário: os endereços vão direto do arquivo para o vetor de quem chama. */
+static long leBinario(leitorTrace_t *leitor, int *enderecos, long maximo)
+{
+    size_t pedidos = (size_t) (maximo < leitor->restantes ? maximo : leitor->restantes) * sizeof(int);
+    size_t lidos = 0;
+
+    while (lidos < pedidos)
+    {
+        ssize_t n = read(leitor->fd, (char *) enderecos + lidos, pedidos - lidos);
+        if (n <= 0)
+        {
+            // O cabeçalho promete mais endereços do que o arquivo tem.
+            return -1;
+        }
+        lidos += (size_t) n;
+    }
+    leitor->restantes -= (long) (lidos / sizeof(int));
+
+    return (long) (lidos / sizeof(int));
+}
+
+long traceLe(leitorTrace_t *leitor, int *enderecos, long maximo)
+{
+    if (!leitor->texto)
+    {
+        return leBinario(leitor, enderecos, maximo);
+    }
+
+    long quantidade = 0;
+
+    while (quantidade < maximo)
+    {
+        char *p = leitor->buffer + leitor->inicio;
+        char *fimTexto = leitor->buffer + leitor->fim;
+        char *quebra = memchr(p, '\n', fimTexto - p);
+
+        if (quebra != NULL || (leitor->fimArquivo && p < fimTexto))
+        {
+            // Uma linha completa, ou a última do arquivo sem quebra.
+            char *fimLinha = quebra != NULL ? quebra : fimTexto;
+
+            quantidade += converteLinha(p, (int) (fimLinha - p), fimTexto, enderecos + quantidade);
+            leitor->inicio = fimLinha - leitor->buffer + (quebra != NULL);
+            continue;
+        }
+        if (leitor->fimArquivo)
+        {
+            break;
+        }
+
+        // Só sobrou o começo de uma linha: ele vai para o início do buffer e o resto é lido depois dele.
+        memmove(leitor->buffer, p, fimTexto - p);
+        leitor->fim -= leitor->inicio;
+        leitor->inicio = 0;
+        if (leitor->fim == TAMANHO_BLOCO_TEXTO)
+        {
+            return -1;
+        }
+
+        ssize_t lidos = read(leitor->fd, leitor->buffer + leitor->fim, TAMANHO_BLOCO_TEXTO - leitor->fim);
+        if (lidos < 0)
+        {
+            return -1;
+        }
+        leitor->fim += (size_t) lidos;
+        leitor->fimArquivo = lidos == 0;
+    }
+
+    return quantidade;
+}
+
+void traceFecha(leitorTrace_t *leitor)
+{
+    if (leitor == NULL)
+    {
+        return;
+    }
+
+    close(leitor->fd);
+    free(leitor->buffer);
+    free(leitor);
+}
+
+//==================== Resultados ====================
+
+FILE *resultadoAbre(const char *caminho)
+{
+    FILE *arquivo = fopen(caminho, "wb");
+    if (arquivo == NULL)
+    {
+        return NULL;
+    }
+
+    // Cabeçalho provisório, com a quantidade preenchida no fim.
+    cabecalhoResultado_t cabecalho;
+    memcpy(cabecalho.magica, RESULTADO_MAGICA, sizeof(cabecalho.magica));
+    cabecalho.tamanhoRegistro = sizeof(registroResultado_t);
+    cabecalho.quantidade = 0;
+
+    if (fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo) != 1)
+    {
+        fclose(arquivo);
+        return NULL;
+    }
+
+    return arquivo;
+}
+
+int resultadoGrava(FILE *arquivo, const registroResultado_t *registros, long n)
+{
+    return fwrite(registros, sizeof(registroResultado_t), n, arquivo) == (size_t) n ? 0 : -1;
+}
+
+int resultadoFecha(FILE *arquivo, long quantidade)
+{
+    int64_t total = quantidade;
+    int erro = fseek(arquivo, offsetof(cabecalhoResultado_t, quantidade), SEEK_SET) != 0 ||
+               fwrite(&total, sizeof(total), 1, arquivo) != 1;
+
+    return (fclose(arquivo) != 0 || erro) ? -1 : 0;
+}
+
+const registroResultado_t *resultadoMapeia(const char *caminho, long *quantidade)
+{
+    int fd = open(caminho, O_RDONLY);
+    if (fd == -1)
+    {
+        return NULL;
+    }
+
+    cabecalhoResultado_t cabecalho;
+    struct stat info;
+
+    if (read(fd, &cabecalho, sizeof(cabecalho)) != (ssize_t) sizeof(cabecalho) ||
+        memcmp(cabecalho.magica, RESULTADO_MAGICA, sizeof(cabecalho.magica)) != 0 ||
+        cabecalho.tamanhoRegistro != sizeof(registroResultado_t) || cabecalho.quantidade < 0 ||
+        fstat(fd, &info) == -1 ||
+        (size_t) info.st_size < sizeof(cabecalho) + (size_t) cabecalho.quantidade * sizeof(registroResultado_t))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    size_t tamanho = sizeof(cabecalho) + (size_t) cabecalho.quantidade * sizeof(registroResultado_t);
+    cabecalhoResultado_t *mapeado = mmap(0, tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapeado == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    *quantidade = (long) cabecalho.quantidade;
+
+    return (const registroResultado_t *) (mapeado + 1);
+}
+
+void resultadoLibera(const registroResultado_t *registros, long quantidade)
+{
+    if (registros != NULL)
+    {
+        munmap((cabecalhoResultado_t *) registros - 1,
+               sizeof(cabecalhoResultado_t) + (size_t) quantidade * sizeof(registroResultado_t));
+    }
+}
@@ -0,0 +1,134 @@
+/*
+  Leitura de traces de endereços e gravação dos resultados.
+  Um trace pode estar em texto (um endereço decimal por linha, como adresses.txt)
+  ou no formato binário: um cabeçalhoTrace_t seguido de "quantidade" inteiros de 32 bits.
+  Os resultados binários são um cabecalhoResultado_t seguido de registros de tamanho
+  fixo, que podem ser mapeados com mmap e percorridos direto.
+
+  Além de endereços, o trace em texto pode ter operações sobre a página de um
+  endereço, no estilo de munmap/madvise:
+    U endereco   desmapeia a página e libera o quadro
+    D endereco   MADV_DONTNEED: libera o quadro, o próximo acesso é uma falta
+    W endereco   MADV_WILLNEED: carrega a página antes do primeiro acesso
+  e escritas, que são referências como as outras mas deixam a página suja:
+    E endereco   escreve no endereço
+  No vetor de endereços operações e escritas são números negativos (traceOperacao).
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define TRACE_MAGICA "TRC1"
+
+typedef struct
+{
+    char magica[4];       // TRACE_MAGICA
+    uint32_t reservado;
+    int64_t quantidade;   // Número de endereços após o cabeçalho.
+} cabecalhoTrace_t;
+
+#define TRACE_BITS_ENDERECO 29   // Endereços de operações ficam abaixo de 2^29.
+#define TRACE_OPERACAO_UNMAP 1
+#define TRACE_OPERACAO_DONTNEED 2
+#define TRACE_OPERACAO_WILLNEED 3
+#define TRACE_ESCRITA 0          // Não é operação: referência de escrita no endereço.
+
+/* Codifica uma operação sobre o endereço como um número negativo do trace. */
+static inline int traceOperacao(int operacao, int endereco)
+{
+    return (int) (0x80000000u | ((unsigned int) operacao << TRACE_BITS_ENDERECO) |
+                  ((unsigned int) endereco & ((1u << TRACE_BITS_ENDERECO) - 1)));
+}
+
+static inline int traceTipoOperacao(int valor)
+{
+    return (int) (((unsigned int) valor >> TRACE_BITS_ENDERECO) & 3);
+}
+
+static inline int traceEnderecoOperacao(int valor)
+{
+    return valor & ((1 << TRACE_BITS_ENDERECO) - 1);
+}
+
+/* Se o valor é uma operação unmap/madvise, e não uma referência (leitura ou escrita). */
+static inline int traceEhOperacao(int valor)
+{
+    return valor < 0 && traceTipoOperacao(valor) != TRACE_ESCRITA;
+}
+
+/* Endereço referenciado por uma leitura ou escrita. */
+static inline int traceEndereco(int valor)
+{
+    return valor < 0 ? traceEnderecoOperacao(valor) : valor;
+}
+
+#define RESULTADO_MAGICA "RES1"
+
+typedef struct
+{
+    int32_t enderecoVirtual;
+    int32_t enderecoFisico;
+    uint8_t valor;
+    uint8_t flags;        // RESULTADO_* (simulador.h). Operações têm enderecoFisico -1.
+    uint16_t reservado;
+} registroResultado_t;
+
+typedef struct
+{
+    char magica[4];       // RESULTADO_MAGICA
+    uint32_t tamanhoRegistro;
+    int64_t quantidade;   // Número de registros após o cabeçalho.
+} cabecalhoResultado_t;
+
+/* Devolve o número de núcleos disponíveis, usado quando numThreads <= 0. */
+int traceThreadsPadrao(void);
+
+/*
+ Lê um trace em texto com numThreads threads e devolve um vetor alocado com malloc.
+ Linhas vazias são ignoradas. Retorna NULL em caso de erro.
+ */
+int *traceLeTexto(const char *caminho, int numThreads, long *quantidade);
+
+/* Converte um trace em texto direto para o formato binário. Retorna a quantidade de endereços ou -1. */
+long traceConverteTexto(const char *entrada, const char *saida, int numThreads);
+
+/*
+ Carrega um trace de qualquer formato (decide pela TRACE_MAGICA).
+ Traces binários são mapeados com mmap, os de texto são lidos com traceLeTexto.
+ O resultado deve ser liberado com traceLibera.
+ */
+const int *traceCarrega(const char *caminho, int numThreads, long *quantidade);
+
+void traceLibera(const int *enderecos, long quantidade);
+
+/*
+ Leitor de um trace de qualquer formato em blocos, para quem só percorre o trace uma
+ vez: a memória usada não cresce com o tamanho do trace.
+ */
+typedef struct leitorTrace leitorTrace_t;
+
+leitorTrace_t *traceAbre(const char *caminho);
+
+/* Preenche até maximo endereços e retorna quantos; 0 no fim do trace e -1 em caso de erro. */
+long traceLe(leitorTrace_t *leitor, int *enderecos, long maximo);
+
+void traceFecha(leitorTrace_t *leitor);
+
+/* Cria um arquivo de resultados. O cabeçalho só fica completo em resultadoFecha. */
+FILE *resultadoAbre(const char *caminho);
+
+/* Acrescenta n registros. Retorna 0 ou -1. */
+int resultadoGrava(FILE *arquivo, const registroResultado_t *registros, long n);
+
+/* Grava a quantidade final no cabeçalho e fecha o arquivo. Retorna 0 ou -1. */
+int resultadoFecha(FILE *arquivo, long quantidade);
+
+/* Mapeia um arquivo de resultados para leitura. Liberar com resultadoLibera. */
+const registroResultado_t *resultadoMapeia(const char *caminho, long *quantidade);
+
+void resultadoLibera(const registroResultado_t *registros, long quantidade);
+
+#endif
@@ -1,304 +1,340 @@
 #include <stdio.h>
-#include <sys/mman.h>
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define TAMANHO_TLB 16
-#define PAGINAS 1024
-#define FRAMES 256
-#define MASCARA_PAGINA 1023
-#define TAMANHO_PAGINA 1024
-#define BITS_DESLOCAMENTO 10
-#define MASCARA_DESLOCAMENTO 1023
-#define TAMANHO_MEMORIA_LOGICA  PAGINAS * TAMANHO_PAGINA
-#define TAMANHO_MEMORIA_FISICA FRAMES * TAMANHO_PAGINA
-#define TAMANHO_BUFFER 10
+#include "simulador.h"
+#include "trace.h"
 
-//==================== Funções, Variáveis Globais, Structs ====================
+#define TAMANHO_LOTE 4096
 
-int proximoQuadroFIFO = 0;
+//==================== Funções, Variáveis Globais ====================
 
-int max(int a, int b)
+int modoPrograma = 0;
+
+void apresentacao()
 {
-    if (a > b) return a;  return b;
+    printf("\t\t========== Virtual Manager ==========\n\n");
 }
 
-// Estrutura de dados FILA
-struct no
+/* Grava o resultado de um lote já traduzido como registros binários. */
+int gravaLote(FILE *arquivo, const int *enderecos, const int *fisicos, const unsigned char *valores,
+              const unsigned char *flags, int n)
 {
-    int dado;
-    int idade;
-    struct no *proximo;
-};
-
-typedef struct no no_t;
+    static registroResultado_t registros[TAMANHO_LOTE];
 
-no_t *cabecaFila;
-int tamanhoFila = 0;
+    for (int i = 0; i < n; i++)
+    {
+        // Escritas são gravadas com o endereço; a flag RESULTADO_ESCRITA as distingue das leituras.
+        registros[i].enderecoVirtual = flags[i] & RESULTADO_ESCRITA ? traceEndereco(enderecos[i]) : enderecos[i];
+        registros[i].enderecoFisico = fisicos[i];
+        registros[i].valor = valores[i];
+        registros[i].flags = flags[i];
+        registros[i].reservado = 0;
+    }
 
-void filaInicializa()
-{
-    // Inicia a fila
-    cabecaFila = malloc(sizeof(no_t));
-    cabecaFila->idade = 0;
-    cabecaFila->proximo = NULL;
+    return resultadoGrava(arquivo, registros, n);
 }
 
-int filaRemove()
+/* Imprime o resultado de um lote já traduzido. As operações do trace não geram linha. */
+void imprimeLote(const int *enderecos, const int *fisicos, const unsigned char *valores, int n)
 {
-    // Remove a fila
-    no_t *atual = cabecaFila;
-    no_t *minPrev = cabecaFila;
-
-    int idadeMin = -1;
-
-    while(atual->proximo != NULL)
+    for (int i = 0; i < n; i++)
     {
-        if(idadeMin < atual->proximo->idade)
+        if (traceEhOperacao(enderecos[i]))
         {
-            idadeMin = atual->proximo->idade;
-            minPrev = atual;
+            continue;
         }
-        atual = atual->proximo;
+        printf("Memoria Virtual: %d Memoria Fisica: %d Valor: %d\n", traceEndereco(enderecos[i]), fisicos[i], valores[i]);
     }
-    no_t *temp = minPrev->proximo->proximo;
-    int valor = minPrev->proximo->dado;
-    free(minPrev->proximo);
-    minPrev->proximo = temp;
-    tamanhoFila--;
-
-    return valor;
 }
 
-void filaIncrementaIdade()
+/* Uma linha da decomposição do tempo efetivo de acesso. */
+void imprimeCusto(const char *componente, double custo, double total, long referencias)
 {
-    no_t *atual = cabecaFila;
-
-    while(atual->proximo != NULL)
-    {
-        atual->proximo->idade++;
-        atual = atual->proximo;
-    }
+    printf("  %-18s %10.1f ns por acesso (%5.1f%%)\n", componente, custo / referencias,
+           total > 0 ? 100.0 * custo / total : 0.0);
 }
 
-int filaAdiciona(int i)
+// ==================== MAIN ====================
+int main(int argc, const char *argv[])
 {
-    // adiciona elemento a fila
-    filaIncrementaIdade();
-    no_t *atual = cabecaFila;
-
-    while(atual->proximo != NULL)
-    {
-        atual = atual->proximo;
-
-        if(atual->dado == i)
-        {
-            atual->idade = 0;
+    apresentacao();
 
-            return 0;
-        }
-    }
-    no_t *novoNo = malloc(sizeof(no_t));
-    novoNo->idade = 0;
-    novoNo->dado = i;
-    novoNo->proximo = NULL;
-    atual->proximo = novoNo;
-    tamanhoFila++;
-
-    if(tamanhoFila > FRAMES)
+    if (argc < 3)
     {
-        return filaRemove();
+        fprintf(stderr, "Uso ./virtmem entrada backingstore [-g bitsDeslocamento paginas quadros] [-t quadrosLentos] [-l latenciaRapida latenciaLenta] [-b saida.res] [-e mmap|pread|direto|cache] [-c paginasCache] [-k periodoEnvelhecimento] [-m tlb tabela falta escrita] [-s posicao checkpoint] [-r checkpoint]\n");
+        exit(1);
     }
 
-    return 0;
-}
-
-struct entradaTLB
-{
-    int logica;
-    int fisica;
-};
-
-int modoPrograma = 0;
-struct entradaTLB tlb[TAMANHO_TLB];
-int indiceTLB = 0;
-int tabelaPaginas[PAGINAS];
-unsigned char memoriaPrincipal[TAMANHO_MEMORIA_FISICA];
-unsigned char *suporte;
-
-
-int buscaTLB(int paginaLogica)
-{
-    for(int i = 0; i < TAMANHO_TLB; i++)
+    /*
+     -g muda a geometria da memória (o padrão é o do simuladorConfigPadrao).
+     -t acrescenta uma camada lenta de memória e -l define as latências (ns) das duas camadas.
+     -b grava os resultados em registros binários (trace.h) em vez de imprimi-los.
+     -e escolhe o motor de E/S do BACKING_STORE e -c o tamanho do cache do motor "cache".
+     -k define de quantas em quantas referências os contadores do envelhecimento são deslocados.
+     -m define as latências (ns) do modelo de custo e imprime o tempo efetivo de acesso.
+     Opções de checkpoint: -s grava o estado depois de "posicao" endereços, -r continua de um estado gravado.
+     */
+    configSimulador_t config;
+    simuladorConfigPadrao(&config);
+
+    long posicaoSalva = -1;
+    const char *arquivoSalva = NULL;
+    const char *arquivoRestaura = NULL;
+    const char *arquivoResultados = NULL;
+    int mostraES = 0;
+    int mostraCusto = 0;
+
+    for (int i = 3; i < argc; i++)
     {
-        if(tlb[i].logica == paginaLogica)
+        if (strcmp(argv[i], "-g") == 0 && i + 3 < argc)
         {
-            return tlb[i].fisica;
+            config.bitsDeslocamento = atoi(argv[i + 1]);
+            config.paginas = atoi(argv[i + 2]);
+            config.quadros = atoi(argv[i + 3]);
+            i += 3;
         }
-    }
-
-    return -1;
-}
-
-
-void adicionaTLB(int pagina, int quadro)
-{
-    for(int i = 0; i < TAMANHO_TLB; i++)
-    {
-        if(tlb[i].fisica == quadro)
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
         {
-            tlb[i].logica = pagina;
-            return;
+            config.quadrosLentos = atoi(argv[i + 1]);
+            i++;
         }
-    }
-
-    tlb[indiceTLB % TAMANHO_TLB].logica = pagina;
-    tlb[indiceTLB % TAMANHO_TLB].fisica = quadro;
-    indiceTLB++;
-}
-
-int substituicaoFIFO()
-{
-    int valorRetorno = -1;
-
-    for(int i =0;i<PAGINAS; i++)
-    {
-        if(tabelaPaginas[i] == proximoQuadroFIFO)
+        else if (strcmp(argv[i], "-l") == 0 && i + 2 < argc)
         {
-            valorRetorno = i;
-
-            break;
+            config.latenciaRapida = atoi(argv[i + 1]);
+            config.latenciaLenta = atoi(argv[i + 2]);
+            i += 2;
+        }
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+        {
+            arquivoResultados = argv[i + 1];
+            i++;
+        }
+        else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc)
+        {
+            int motor = suporteMotorPorNome(argv[i + 1]);
+            if (motor == -1)
+            {
+                fprintf(stderr, "Motor de E/S inválido: %s\n", argv[i + 1]);
+                exit(1);
+            }
+            config.motorES = (motorES_t) motor;
+            mostraES = 1;
+            i++;
+        }
+        else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+        {
+            config.paginasCacheES = atoi(argv[i + 1]);
+            i++;
+        }
+        else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc)
+        {
+            config.periodoEnvelhecimento = atoi(argv[i + 1]);
+            i++;
+        }
+        else if (strcmp(argv[i], "-m") == 0 && i + 4 < argc)
+        {
+            config.latenciaTLB = atoi(argv[i + 1]);
+            config.latenciaTabela = atoi(argv[i + 2]);
+            config.latenciaFalta = atoi(argv[i + 3]);
+            config.latenciaEscrita = atoi(argv[i + 4]);
+            mostraCusto = 1;
+            i += 4;
+        }
+        else if (strcmp(argv[i], "-s") == 0 && i + 2 < argc)
+        {
+            posicaoSalva = atol(argv[i + 1]);
+            arquivoSalva = argv[i + 2];
+            i += 2;
+        }
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+        {
+            arquivoRestaura = argv[i + 1];
+            i++;
+        }
+        else
+        {
+            fprintf(stderr, "Opção inválida: %s\n", argv[i]);
+            exit(1);
         }
     }
 
-    return valorRetorno;
-}
-
-int substituicaoLRU()
-{
-    return filaRemove();
-}
+    simulador_t *sim;
 
-int substituicao(int pagina)
-{
-    int paginaAntiga = 0;
-
-    if(modoPrograma)
+    if (arquivoRestaura != NULL)
     {
-        paginaAntiga = substituicaoLRU();
+        // A política, o motor de E/S e as latências vêm do checkpoint.
+        sim = simuladorRestaura(arquivoRestaura, argv[2]);
+        if (sim == NULL)
+        {
+            fprintf(stderr, "Erro ao restaurar o checkpoint %s\n", arquivoRestaura);
+            exit(1);
+        }
     }
     else
     {
-        paginaAntiga = substituicaoFIFO();
-    }
-
-    int quadro =  tabelaPaginas[paginaAntiga];
-    tabelaPaginas[paginaAntiga] = -1;
-
-    return quadro;
-}
+        printf("Deseja executar o programa como:\n [0] LRU\n [1] FIFO\n [2] Envelhecimento\n [3] Relógio\n" );
+        scanf("%d", &modoPrograma);
 
-void apresentacao()
-{
-    printf("\t\t========== Virtual Manager ==========\n\n");
-}
+        if (modoPrograma == 2)
+        {
+            config.politica = POLITICA_ENVELHECIMENTO;
+        }
+        else if (modoPrograma == 3)
+        {
+            config.politica = POLITICA_RELOGIO;
+        }
+        else
+        {
+            config.politica = modoPrograma ? POLITICA_LRU : POLITICA_FIFO;
+        }
+        config.arquivoBacking = argv[2];
 
-// ==================== MAIN ====================
-int main(int argc, const char *argv[])
-{
-    apresentacao();
+        sim = simuladorCria(&config);
+        if (sim == NULL)
+        {
+            fprintf(stderr, "Erro ao abrir o arquivo de backing store %s com o motor %s\n", argv[2],
+                    suporteNomeMotor(config.motorES));
+            exit(1);
+        }
+    }
 
-    if (argc !=3)
+    // Aceita o trace em texto ou no formato binário gerado pelo conversorTrace.
+    const char *nomeArquivoEntrada = argv[1];
+    long quantidade = 0;
+    const int *enderecos = traceCarrega(nomeArquivoEntrada, 0, &quantidade);
+    if (enderecos == NULL)
     {
-        fprintf(stderr, "Uso ./virtmem entrada backingstore 0/1\n");
+        fprintf(stderr, "Erro ao abrir o arquivo de entrada %s\n", nomeArquivoEntrada);
+        simuladorDestroi(sim);
         exit(1);
     }
 
-    printf("Deseja executar o programa como:\n [0] LRU\n [1] FIFO\n" );
-    scanf("%d", &modoPrograma);
-    filaInicializa();
-
-    const char *nomeArquivoBacking = argv[2];
-    int descritorBacking = open(nomeArquivoBacking, O_RDONLY);
-    suporte = mmap(0, TAMANHO_MEMORIA_LOGICA, PROT_READ, MAP_PRIVATE, descritorBacking, 0);
+    static int fisicos[TAMANHO_LOTE];
+    static unsigned char valores[TAMANHO_LOTE];
+    static unsigned char flags[TAMANHO_LOTE];
 
-    const char *nomeArquivoEntrada = argv[1];
-    FILE *arquivoEntrada = fopen(nomeArquivoEntrada, "r");
-
-    int i;
-    for (i = 0; i < PAGINAS; i++)
+    FILE *saidaResultados = NULL;
+    if (arquivoResultados != NULL && (saidaResultados = resultadoAbre(arquivoResultados)) == NULL)
     {
-        tabelaPaginas[i] = -1;
+        fprintf(stderr, "Erro ao criar o arquivo de resultados %s\n", arquivoResultados);
+        exit(1);
     }
 
-    char buffer[TAMANHO_BUFFER];
-
-    int totalEnderecos = 0;
-    int acertosTLB = 0;
-    int faltasPagina = 0;
-
-    int numQuadrosLivres = FRAMES;
+    // Depois de um restore a simulação continua na posição do trace em que o checkpoint foi gravado.
+    estatisticasSimulador_t estatisticas;
+    simuladorEstatisticas(sim, &estatisticas);
 
-    signed char *localTransferenciaMemoriaPrincipal = 0;
-    signed char *localDadosBackingStore = 0;
+    long posicaoTrace = estatisticas.totalEnderecos + estatisticas.operacoes;
+    long inicioTrace = posicaoTrace < quantidade ? posicaoTrace : quantidade;
 
-    while (fgets(buffer, TAMANHO_BUFFER, arquivoEntrada) != NULL)
+    for (long inicio = inicioTrace; inicio < quantidade; )
     {
-        totalEnderecos++;
-        int enderecoLogico = atoi(buffer);
+        long fim = inicio + TAMANHO_LOTE < quantidade ? inicio + TAMANHO_LOTE : quantidade;
 
-        int deslocamento = enderecoLogico & MASCARA_DESLOCAMENTO;
-        int pagina = (enderecoLogico >> BITS_DESLOCAMENTO) & MASCARA_PAGINA;
-        int quadro = buscaTLB(pagina);
-
-        if (quadro != -1)
+        if (posicaoSalva > inicio && posicaoSalva < fim)
         {
-            acertosTLB++;
+            fim = posicaoSalva;
         }
-        else
+
+        simuladorTraduzLoteFlags(sim, enderecos + inicio, (int) (fim - inicio), fisicos, valores, flags);
+
+        if (saidaResultados != NULL)
         {
-            quadro = tabelaPaginas[pagina];
-            if (quadro == -1)
+            if (gravaLote(saidaResultados, enderecos + inicio, fisicos, valores, flags, (int) (fim - inicio)) == -1)
             {
-                faltasPagina++;
-
-                if(numQuadrosLivres > 0)
-                {
-                    quadro = FRAMES - numQuadrosLivres;
-                    numQuadrosLivres--;
-                }
-                else
-                {
-                    quadro = substituicao(pagina);
-                }
-                proximoQuadroFIFO = (proximoQuadroFIFO+1)%FRAMES;
-                localTransferenciaMemoriaPrincipal = memoriaPrincipal + (quadro * TAMANHO_PAGINA);
-                localDadosBackingStore = suporte + (pagina * TAMANHO_PAGINA);
-                memcpy(localTransferenciaMemoriaPrincipal, localDadosBackingStore, TAMANHO_PAGINA);
-                tabelaPaginas[pagina] = quadro;
+                fprintf(stderr, "Erro ao gravar o arquivo de resultados %s\n", arquivoResultados);
+                exit(1);
             }
-            adicionaTLB(pagina, quadro);
         }
+        else
+        {
+            imprimeLote(enderecos + inicio, fisicos, valores, (int) (fim - inicio));
+        }
+        inicio = fim;
 
-        if(modoPrograma)
+        if (inicio == posicaoSalva && simuladorSalva(sim, arquivoSalva) == -1)
         {
-            filaAdiciona(pagina);
+            fprintf(stderr, "Erro ao gravar o checkpoint %s\n", arquivoSalva);
         }
+    }
 
-        int enderecoFisico = (quadro << BITS_DESLOCAMENTO) | deslocamento;
-        unsigned char valor = memoriaPrincipal[quadro * TAMANHO_PAGINA + deslocamento];
+    simuladorEstatisticas(sim, &estatisticas);
 
-        printf("Memoria Virtual: %d Memoria Fisica: %d Valor: %d\n", enderecoLogico, enderecoFisico, valor);
+    if (saidaResultados != NULL && resultadoFecha(saidaResultados, quantidade - inicioTrace) == -1)
+    {
+        fprintf(stderr, "Erro ao gravar o arquivo de resultados %s\n", arquivoResultados);
     }
+
     printf("=====================================\n");
-    printf("Número de Endereços Traduzidos = %d\n", totalEnderecos);
-    printf("Faltas de Página = %d\n", faltasPagina);
-    printf("Taxa de Faltas de Página = %.3f\n", faltasPagina / (1. * totalEnderecos));
-    printf("Acertos TLB = %d\n", acertosTLB);
-    printf("Taxa de Acertos TLB = %.3f\n", acertosTLB / (1. * totalEnderecos));
+    printf("Número de Endereços Traduzidos = %ld\n", estatisticas.totalEnderecos);
+    printf("Faltas de Página = %ld\n", estatisticas.faltasPagina);
+    printf("Taxa de Faltas de Página = %.3f\n", estatisticas.faltasPagina / (1. * estatisticas.totalEnderecos));
+    printf("Acertos TLB = %ld\n", estatisticas.acertosTLB);
+    printf("Taxa de Acertos TLB = %.3f\n", estatisticas.acertosTLB / (1. * estatisticas.totalEnderecos));
+
+    if (estatisticas.escritas > 0)
+    {
+        printf("Escritas = %ld\n", estatisticas.escritas);
+        printf("Páginas Sujas Gravadas de Volta = %ld\n", estatisticas.escritasDeVolta);
+    }
+
+    if (estatisticas.acessosLentos > 0 || estatisticas.promocoes > 0)
+    {
+        printf("Acessos Camada Rápida = %ld\n", estatisticas.acessosRapidos);
+        printf("Acessos Camada Lenta = %ld\n", estatisticas.acessosLentos);
+        printf("Promoções = %ld\n", estatisticas.promocoes);
+        printf("Rebaixamentos = %ld\n", estatisticas.rebaixamentos);
+        printf("Bytes Migrados = %ld\n", estatisticas.bytesMigrados);
+        printf("Custo Médio por Acesso = %.1f ns (acessos %.1f ns + migrações %.1f ns)\n",
+               (estatisticas.custoAcessos + estatisticas.custoMigracoes) / estatisticas.totalEnderecos,
+               estatisticas.custoAcessos / estatisticas.totalEnderecos,
+               estatisticas.custoMigracoes / estatisticas.totalEnderecos);
+    }
+
+    if (estatisticas.operacoes > 0)
+    {
+        printf("Operações unmap/DONTNEED/WILLNEED = %ld/%ld/%ld\n", estatisticas.operacoesUnmap,
+               estatisticas.operacoesDontneed, estatisticas.operacoesWillneed);
+        printf("Quadros Liberados = %ld\n", estatisticas.quadrosLiberados);
+        printf("Faltas em Páginas Liberadas = %ld\n", estatisticas.faltasAposLiberacao);
+        printf("Páginas Pré-carregadas = %ld (usadas %ld)\n", estatisticas.preCarregamentos,
+               estatisticas.preCarregamentosUsados);
+        printf("Substituições = %ld\n", estatisticas.substituicoes);
+        printf("Quadros em Uso = %ld (pico %ld)\n", estatisticas.quadrosEmUso, estatisticas.picoQuadrosEmUso);
+    }
+
+    if (mostraCusto && estatisticas.totalEnderecos > 0)
+    {
+        double total = estatisticas.tempoEfetivoAcesso * estatisticas.totalEnderecos;
+
+        const char *nomesPoliticas[] = {"FIFO", "LRU", "Envelhecimento", "Relógio"};
+        printf("Política = %s\n", nomesPoliticas[simuladorConfig(sim)->politica]);
+        printf("Tempo Efetivo de Acesso = %.1f ns\n", estatisticas.tempoEfetivoAcesso);
+        imprimeCusto("TLB", estatisticas.custoTLB, total, estatisticas.totalEnderecos);
+        imprimeCusto("Tabela de Páginas", estatisticas.custoTabela, total, estatisticas.totalEnderecos);
+        imprimeCusto("Memória", estatisticas.custoAcessos, total, estatisticas.totalEnderecos);
+        imprimeCusto("Faltas de Página", estatisticas.custoFaltas, total, estatisticas.totalEnderecos);
+        imprimeCusto("Escrita de Volta", estatisticas.custoEscritas, total, estatisticas.totalEnderecos);
+        imprimeCusto("Migrações", estatisticas.custoMigracoes, total, estatisticas.totalEnderecos);
+    }
+
+    if (mostraES)
+    {
+        printf("Motor de E/S = %s\n", suporteNomeMotor(simuladorConfig(sim)->motorES));
+        printf("Leituras do Backing Store = %ld\n", estatisticas.es.leituras);
+        printf("Bytes Lidos = %ld\n", estatisticas.es.bytesLidos);
+        printf("Tempo de E/S = %.3f ms (%.2f us por falta)\n", estatisticas.es.segundos * 1e3,
+               estatisticas.faltasPagina > 0 ? estatisticas.es.segundos * 1e6 / estatisticas.faltasPagina : 0.0);
+        if (simuladorConfig(sim)->motorES == MOTOR_CACHE)
+        {
+            printf("Acertos no Cache de E/S = %ld\n", estatisticas.es.acertosCache);
+            printf("Faltas no Cache de E/S = %ld\n", estatisticas.es.faltasCache);
+        }
+    }
+
+    traceLibera(enderecos, quantidade);
+    simuladorDestroi(sim);
 
     return 0;
 }